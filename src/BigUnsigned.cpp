@@ -0,0 +1,163 @@
+#include "BigUnsigned.h"
+#include <algorithm>
+
+namespace ClassProject {
+
+    /**
+     * @brief Construct from a 64 bit value
+     *
+     * @param value initial value, 0 leaves no limbs
+     * @author Victor Herbert
+     */
+    BigUnsigned::BigUnsigned(uint64_t value){
+        while(value != 0){
+            limbs.push_back((uint32_t) value);
+            value >>= 32;
+        }
+    }
+
+    /**
+     * @brief Drops the leading zero limbs, so equal values have equal limbs
+     *
+     * @author Victor Herbert
+     */
+    void BigUnsigned::trim(){
+        while(!limbs.empty() && limbs.back() == 0)
+            limbs.pop_back();
+    }
+
+    /**
+     * @brief Adds other limb by limb, propagating the carry
+     *
+     * @param other summand
+     * @return BigUnsigned& this
+     * @author Victor Herbert
+     */
+    BigUnsigned &BigUnsigned::operator+=(const BigUnsigned &other){
+        if(other.limbs.size() > limbs.size())
+            limbs.resize(other.limbs.size(), 0);
+
+        uint64_t carry = 0;
+        for(size_t i = 0; i < limbs.size(); i++){
+            uint64_t sum = carry + limbs[i] + (i < other.limbs.size() ? other.limbs[i] : 0);
+            limbs[i] = (uint32_t) sum;
+            carry = sum >> 32;
+        }
+        if(carry != 0)
+            limbs.push_back((uint32_t) carry);
+        return *this;
+    }
+
+    /**
+     * @brief Multiplies by 2^shift
+     *
+     * @param shift number of bits
+     * @return BigUnsigned& this
+     * @author Victor Herbert
+     */
+    BigUnsigned &BigUnsigned::operator<<=(size_t shift){
+        if(limbs.empty())
+            return *this;
+
+        size_t bits = shift % 32;
+        limbs.insert(limbs.begin(), shift / 32, 0);
+        if(bits != 0){
+            uint32_t carry = 0;
+            for(uint32_t &limb : limbs){
+                uint32_t next = limb >> (32 - bits);
+                limb = (limb << bits) | carry;
+                carry = next;
+            }
+            if(carry != 0)
+                limbs.push_back(carry);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Divides by 2^shift, rounding down
+     *
+     * @param shift number of bits
+     * @return BigUnsigned& this
+     * @author Victor Herbert
+     */
+    BigUnsigned &BigUnsigned::operator>>=(size_t shift){
+        size_t words = std::min(shift / 32, limbs.size());
+        limbs.erase(limbs.begin(), limbs.begin() + words);
+
+        size_t bits = shift % 32;
+        if(bits != 0){
+            for(size_t i = 0; i < limbs.size(); i++){
+                uint32_t next = i + 1 < limbs.size() ? limbs[i + 1] << (32 - bits) : 0;
+                limbs[i] = (limbs[i] >> bits) | next;
+            }
+        }
+        trim();
+        return *this;
+    }
+
+    /**
+     * @brief Compares the limbs, which are unique per value as they carry no leading zeros
+     *
+     * @author Victor Herbert
+     */
+    bool BigUnsigned::operator==(const BigUnsigned &other) const{
+        return limbs == other.limbs;
+    }
+
+    /**
+     * @brief Negation of operator==
+     *
+     * @author Victor Herbert
+     */
+    bool BigUnsigned::operator!=(const BigUnsigned &other) const{
+        return limbs != other.limbs;
+    }
+
+    /**
+     * @brief Nearest double, infinity if the value exceeds the double range
+     *
+     * @author Victor Herbert
+     */
+    double BigUnsigned::toDouble() const{
+        double value = 0;
+        for(size_t i = limbs.size(); i-- > 0;)
+            value = value * 4294967296.0 + limbs[i];
+        return value;
+    }
+
+    /**
+     * @brief Decimal representation
+     *
+     * @author Victor Herbert
+     */
+    std::string BigUnsigned::toString() const{
+        if(limbs.empty())
+            return "0";
+
+        // repeated division by 10^9, collecting nine decimal digits per step
+        std::vector<uint32_t> quotient(limbs);
+        std::string digits;
+        while(!quotient.empty()){
+            uint64_t remainder = 0;
+            for(size_t i = quotient.size(); i-- > 0;){
+                uint64_t current = (remainder << 32) | quotient[i];
+                quotient[i] = (uint32_t) (current / 1000000000);
+                remainder = current % 1000000000;
+            }
+            while(!quotient.empty() && quotient.back() == 0)
+                quotient.pop_back();
+
+            for(int i = 0; i < 9; i++){
+                digits.push_back((char) ('0' + remainder % 10));
+                remainder /= 10;
+            }
+        }
+
+        while(digits.size() > 1 && digits.back() == '0')
+            digits.pop_back();
+        std::reverse(digits.begin(), digits.end());
+        return digits;
+    }
+
+}
@@ -0,0 +1,49 @@
+// A minimalistic BDD library, following Wolfgang Kunz lecture slides
+//
+// Created by Markus Wedler 2014
+
+#ifndef VDSPROJECT_BIGUNSIGNED_H
+#define VDSPROJECT_BIGUNSIGNED_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace ClassProject {
+
+    /**
+     * @brief Arbitrary precision unsigned integer, as far as counting minterms needs it
+     *
+     * Only addition and shifts are provided: satisfying assignments are counted as sums
+     * of powers of two. The value is stored as little endian 32 bit limbs without
+     * leading zero limbs.
+     *
+     * @author Victor Herbert
+     */
+    class BigUnsigned {
+    public:
+        BigUnsigned(uint64_t value = 0);
+
+        BigUnsigned &operator+=(const BigUnsigned &other);
+
+        BigUnsigned &operator<<=(size_t shift);
+
+        BigUnsigned &operator>>=(size_t shift);
+
+        bool operator==(const BigUnsigned &other) const;
+
+        bool operator!=(const BigUnsigned &other) const;
+
+        double toDouble() const;
+
+        std::string toString() const;
+
+    private:
+        std::vector<uint32_t> limbs;
+
+        void trim();
+    };
+
+}
+
+#endif
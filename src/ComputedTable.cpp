@@ -0,0 +1,167 @@
+#include "ComputedTable.h"
+#include <limits>
+#include <algorithm>
+
+namespace ClassProject {
+
+    const BDD_ID ComputedTable::EMPTY = std::numeric_limits<BDD_ID>::max();
+    const size_t ComputedTable::DEFAULT_SIZE = 1 << 15;
+    const size_t ComputedTable::DEFAULT_MAX_SIZE = 1 << 20;
+    const double ComputedTable::GROWTH_HIT_RATE = 0.3;
+
+    /**
+     * @brief Construct an empty computed table
+     *
+     * @param size initial number of entries, rounded up to a power of two
+     * @param max_size upper bound for automatic growth
+     * @author Victor Herbert
+     */
+    ComputedTable::ComputedTable(size_t size, size_t max_size)
+        : lookups(0), hits(0), insertions(0), evictions(0), resizes(0), window_lookups(0), window_hits(0), window_evictions(0){
+        resize(size, max_size);
+        resizes = 0;
+    }
+
+    size_t ComputedTable::index(Operation op, BDD_ID f, BDD_ID g, BDD_ID h) const{
+        size_t hash = (f + ((size_t) op << 56)) * 0x9E3779B97F4A7C15ULL;
+        hash = (hash ^ g) * 0xBF58476D1CE4E5B9ULL;
+        hash = (hash ^ h) * 0x94D049BB133111EBULL;
+        return (hash ^ (hash >> 31)) & mask;
+    }
+
+    /**
+     * @brief Searches the result of a previous op(f, g, h)
+     *
+     * @param op operation tag, binary operations pass a constant as h
+     * @param result receives the cached result on a hit
+     * @return bool stating if the triple was found
+     * @author Victor Herbert
+     */
+    bool ComputedTable::lookup(Operation op, BDD_ID f, BDD_ID g, BDD_ID h, BDD_ID &result){
+        const Entry &entry = entries[index(op, f, g, h)];
+        lookups++;
+        window_lookups++;
+
+        if(entry.f == f && entry.g == g && entry.h == h && entry.op == op){
+            hits++;
+            window_hits++;
+            result = entry.result;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Stores the result of op(f, g, h), overwriting whatever shared its entry
+     *
+     * @author Victor Herbert
+     */
+    void ComputedTable::insert(Operation op, BDD_ID f, BDD_ID g, BDD_ID h, BDD_ID result){
+        Entry &entry = entries[index(op, f, g, h)];
+        if(entry.f != EMPTY){
+            evictions++;
+            window_evictions++;
+        }
+
+        entry = {f, g, h, result, op};
+        insertions++;
+
+        // once per table turnover, grow if entries are being evicted from a table that pays off
+        if(window_lookups >= entries.size()){
+            if(entries.size() < max_size && window_evictions > 0 && window_hits >= GROWTH_HIT_RATE * window_lookups)
+                grow();
+            window_lookups = 0;
+            window_hits = 0;
+            window_evictions = 0;
+        }
+    }
+
+    /**
+     * @brief Changes the size of the table, dropping all cached results
+     *
+     * @param size number of entries, rounded up to a power of two
+     * @param max_size upper bound for automatic growth
+     * @author Victor Herbert
+     */
+    void ComputedTable::resize(size_t size, size_t max_size){
+        size_t entries_size = 1;
+        while(entries_size < size)
+            entries_size <<= 1;
+
+        entries.assign(entries_size, {EMPTY, EMPTY, EMPTY, EMPTY, ITE});
+        mask = entries_size - 1;
+        this->max_size = std::max(entries_size, max_size);
+        resizes++;
+    }
+
+    /**
+     * @brief Doubles the table, keeping the cached results
+     *
+     * @author Victor Herbert
+     */
+    void ComputedTable::grow(){
+        std::vector<Entry> old_entries = std::move(entries);
+        entries.assign(old_entries.size() * 2, {EMPTY, EMPTY, EMPTY, EMPTY, ITE});
+        mask = entries.size() - 1;
+        resizes++;
+
+        for(const Entry &entry : old_entries)
+            if(entry.f != EMPTY)
+                entries[index(entry.op, entry.f, entry.g, entry.h)] = entry;
+    }
+
+    /**
+     * @brief Invalidates every entry, keeping the current size
+     *
+     * @author Victor Herbert
+     */
+    void ComputedTable::clear(){
+        std::fill(entries.begin(), entries.end(), Entry{EMPTY, EMPTY, EMPTY, EMPTY, ITE});
+    }
+
+    /**
+     * @brief Invalidates the entries that refer to an id which is no longer alive
+     *
+     * Called after garbage collection, before freed ids can be handed out again
+     *
+     * @param isLive predicate telling if an id still refers to the same node
+     * @return size_t number of invalidated entries
+     * @author Victor Herbert
+     */
+    size_t ComputedTable::purge(const std::function<bool(BDD_ID)> &isLive){
+        size_t purged = 0;
+        for(Entry &entry : entries){
+            if(entry.f == EMPTY)
+                continue;
+            if(!isLive(entry.f) || !isLive(entry.g) || !isLive(entry.h) || !isLive(entry.result)){
+                entry = {EMPTY, EMPTY, EMPTY, EMPTY, ITE};
+                purged++;
+            }
+        }
+        return purged;
+    }
+
+    /**
+     * @brief returns the size and hit, miss and eviction counters of the table
+     *
+     * @return Stats
+     * @author Victor Herbert
+     */
+    ComputedTable::Stats ComputedTable::stats() const{
+        return {
+            .size = entries.size(),
+            .maxSize = max_size,
+            .lookups = lookups,
+            .hits = hits,
+            .misses = lookups - hits,
+            .insertions = insertions,
+            .evictions = evictions,
+            .resizes = resizes
+        };
+    }
+
+    double ComputedTable::Stats::hitRate() const{
+        return lookups == 0 ? 0 : (double) hits / lookups;
+    }
+
+}
@@ -0,0 +1,97 @@
+// A minimalistic BDD library, following Wolfgang Kunz lecture slides
+//
+// Created by Markus Wedler 2014
+
+#ifndef VDSPROJECT_COMPUTEDTABLE_H
+#define VDSPROJECT_COMPUTEDTABLE_H
+
+#include "ManagerInterface.h"
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+namespace ClassProject {
+
+    /**
+     * @brief Lossy direct-mapped cache of operation results
+     *
+     * Entries are tagged with the operation that produced them, so the ite triples and
+     * the operands of the specialized kernels never alias. Every (op, f, g, h) key maps
+     * to exactly one entry of a power of two sized array, a colliding insertion simply
+     * overwrites the previous result. The table doubles
+     * (up to its maximum size) when the hit rate observed since the last resize shows
+     * that the evicted entries were worth keeping.
+     *
+     * @author Victor Herbert
+     */
+    class ComputedTable {
+    public:
+        const static size_t DEFAULT_SIZE;
+        const static size_t DEFAULT_MAX_SIZE;
+        const static double GROWTH_HIT_RATE;
+
+        enum Operation : uint8_t{
+            ITE,
+            AND,
+            XOR,
+            RESTRICT,
+            AND_EXISTS
+        };
+
+        struct Stats{
+            size_t size;
+            size_t maxSize;
+            size_t lookups;
+            size_t hits;
+            size_t misses;
+            size_t insertions;
+            size_t evictions;
+            size_t resizes;
+
+            double hitRate() const;
+        };
+
+        explicit ComputedTable(size_t size = DEFAULT_SIZE, size_t max_size = DEFAULT_MAX_SIZE);
+
+        bool lookup(Operation op, BDD_ID f, BDD_ID g, BDD_ID h, BDD_ID &result);
+
+        void insert(Operation op, BDD_ID f, BDD_ID g, BDD_ID h, BDD_ID result);
+
+        void resize(size_t size, size_t max_size);
+
+        void clear();
+
+        size_t purge(const std::function<bool(BDD_ID)> &isLive);
+
+        Stats stats() const;
+
+    private:
+        const static BDD_ID EMPTY;
+
+        struct Entry{
+            BDD_ID f, g, h, result;
+            Operation op;
+        };
+
+        std::vector<Entry> entries;
+        size_t mask;
+        size_t max_size;
+
+        size_t lookups;
+        size_t hits;
+        size_t insertions;
+        size_t evictions;
+        size_t resizes;
+
+        size_t window_lookups;
+        size_t window_hits;
+        size_t window_evictions;
+
+        size_t index(Operation op, BDD_ID f, BDD_ID g, BDD_ID h) const;
+
+        void grow();
+    };
+
+}
+
+#endif
@@ -1,7 +1,14 @@
 #include "Manager.h"
+#include "Snapshot.h"
 #include <stdexcept>
 #include <fstream>
 #include <unordered_set>
+#include <algorithm>
+#include <limits>
+#include <chrono>
+#include <cmath>
+#include <queue>
+#include <tuple>
 
 //clear &&  make -C build/ VDSProject_bench && ./build/src/bench/VDSProject_bench benchmarks/iscas85/c3540.bench 
 namespace ClassProject {
@@ -11,13 +18,48 @@ namespace ClassProject {
         return stream << node.low << "," << node.high << "," << node.topVar;
     }
 
+    namespace {
+
+        template<typename T>
+        void writeValue(std::ostream &out, T value){
+            out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        template<typename T>
+        T readValue(std::istream &in){
+            T value;
+            if(!in.read(reinterpret_cast<char *>(&value), sizeof(T)))
+                throw std::runtime_error("truncated snapshot");
+            return value;
+        }
+
+        void writeString(std::ostream &out, const std::string &value){
+            writeValue<uint32_t>(out, value.size());
+            out.write(value.data(), value.size());
+        }
+
+        std::string readString(std::istream &in){
+            std::string value(readValue<uint32_t>(in), '\0');
+            if(!in.read(&value[0], value.size()))
+                throw std::runtime_error("truncated snapshot");
+            return value;
+        }
+
+    }
+
     const BDD_ID Manager::FALSE_ADDRESS = 0;
     const BDD_ID Manager::TRUE_ADDRESS = 1;
+    const BDD_ID Manager::COMPLEMENT_BIT = BDD_ID(1) << 31;
 
     const Node Manager::FALSE_NODE = {.low = 0, .high = 0, .topVar = Manager::FALSE_ADDRESS};
     const Node Manager::TRUE_NODE =  {.low = 1, .high = 1, .topVar = Manager::TRUE_ADDRESS};
+    const Level Manager::CONSTANT_LEVEL = std::numeric_limits<Level>::max();
 
-    int count = 0; // FIXME
+#ifdef COLLECT_STATS
+#define STAT(statement) statement
+#else
+#define STAT(statement)
+#endif
 
     /**
     * @brief Manager class standard constructor
@@ -26,12 +68,9 @@ namespace ClassProject {
     * @author Victor Herbert
     */
     Manager::Manager(){
-        unique_table.reserve(UNIQUE_TABLE_CAPACITY);
-        computed_table.reserve(UNIQUE_TABLE_CAPACITY);
-        nodes = {FALSE_NODE, TRUE_NODE};
         labels = {{0, "0"}, {1, "1"}};
-        unique_table.insert({{.low = 0, .high = 0, .topVar = Manager::FALSE_ADDRESS}, FALSE_ADDRESS});
-        unique_table.insert({{.low = 1, .high = 1, .topVar = Manager::TRUE_ADDRESS}, TRUE_ADDRESS});
+        for(const Node &terminal : {FALSE_NODE, TRUE_NODE})
+            storeNode(terminal, CONSTANT_LEVEL, unique_table.lookup(terminal, nodes));
     }
 
     /**
@@ -43,18 +82,45 @@ namespace ClassProject {
      * @param nodes
      * @author Kamel Fakih
      */
-    Manager::Manager(std::vector<Node> nodes) : nodes(nodes){
-        unique_table.reserve(UNIQUE_TABLE_CAPACITY);
-        computed_table.reserve(UNIQUE_TABLE_CAPACITY);
+    Manager::Manager(std::vector<Node> nodes){
         if(!(nodes[0] == FALSE_NODE) || !(nodes[1] == TRUE_NODE)){
             throw std::invalid_argument("true and false nodes are invalid");
         }
 
         // TODO add more validation on input nodes
 
+        for(size_t i=2; i < nodes.size(); i++){
+            if(isComplement(nodes[i].high)){
+                throw std::invalid_argument("high edges must not be complemented");
+            }
+        }
+
+        // variables are ordered by their id, the expressions inherit the level of their top variable
+        std::vector<Level> levels(nodes.size(), CONSTANT_LEVEL);
+        for(size_t i=2; i < nodes.size(); i++){
+            if(nodes[i].topVar == i){
+                levels[i] = level_to_var.size();
+                level_to_var.push_back(i);
+            }
+        }
+
+        this->nodes.reserve(nodes.size());
+        for(size_t i=0; i < nodes.size(); i++){
+            Level level = levels[nodes[i].topVar];
+            this->nodes.push_back({
+                .low = (NodeIndex) nodes[i].low, .high = (NodeIndex) nodes[i].high,
+                .topVar = (NodeIndex) nodes[i].topVar, .level = level, .flags = 0
+            });
+        }
+
         for(size_t i=0; i < nodes.size(); i++){
-            unique_table.insert({nodes[i], i});
+            NodeIndex &slot = unique_table.lookup(nodes[i], this->nodes);
+            if(slot == UniqueTable::EMPTY){
+                slot = i;
+                unique_table.inserted(this->nodes);
+            }
         }
+        STAT(counters.peakNodes = unique_table.size());
     }
 
     /**
@@ -67,6 +133,189 @@ namespace ClassProject {
         return unique_table.size();
     }
 
+    /**
+     * @brief returns the load factor and probe length statistics of the unique table
+     *
+     * @return UniqueTable::Stats
+     * @author Victor Herbert
+     */
+    UniqueTable::Stats Manager::uniqueTableStats(){
+        return unique_table.stats();
+    }
+
+    /**
+     * @brief sets the number of entries of the computed table, clearing it
+     *
+     * The table starts with size entries and may double on its own up to max_size
+     *
+     * @param size initial number of entries, rounded up to a power of two
+     * @param max_size upper bound for the automatic growth
+     * @author Victor Herbert
+     */
+    void Manager::setComputedTableSize(size_t size, size_t max_size){
+        computed_table.resize(size, max_size);
+    }
+
+    /**
+     * @brief returns the size and the hit, miss and eviction counters of the computed table
+     *
+     * @return ComputedTable::Stats
+     * @author Victor Herbert
+     */
+    ComputedTable::Stats Manager::computedTableStats(){
+        return computed_table.stats();
+    }
+
+    /**
+     * @brief returns the operation counters together with the statistics of both tables
+     *
+     * @return Stats
+     * @author Victor Herbert
+     */
+    Manager::Stats Manager::stats(){
+        Stats stats = counters;
+        stats.uniqueTable = unique_table.stats();
+        stats.computedTable = computed_table.stats();
+        return stats;
+    }
+
+    /**
+     * @brief Clears the operation counters, the peak starts over from the current node count
+     *
+     * The counters of the tables keep running
+     *
+     * @author Victor Herbert
+     */
+    void Manager::resetStats(){
+        counters = {};
+        STAT(counters.peakNodes = unique_table.size());
+    }
+
+    /**
+     * @brief registers f as an external root, keeping its nodes alive across garbage collections
+     *
+     * Usually called through a BDDHandle
+     *
+     * @param f root to be kept
+     * @author Victor Herbert
+     */
+    void Manager::ref(BDD_ID f){
+        if(!isConstant(nodeIndex(f)))
+            root_refs[nodeIndex(f)]++;
+    }
+
+    /**
+     * @brief releases a root registered with ref
+     *
+     * @param f root to be released
+     * @author Victor Herbert
+     */
+    void Manager::deref(BDD_ID f){
+        auto root = root_refs.find(nodeIndex(f));
+        if(root != root_refs.end() && --root->second == 0)
+            root_refs.erase(root);
+    }
+
+    /**
+     * @brief frees every node that is not reachable from a variable or a registered root
+     *
+     * Any BDD_ID which is not kept by a BDDHandle (or ref) may be invalidated and its
+     * slot handed out again to a different node.
+     *
+     * @return size_t number of freed nodes
+     * @author Victor Herbert
+     */
+    size_t Manager::collectGarbage(){
+        return markAndSweep({});
+    }
+
+    /**
+     * @brief enables the automatic garbage collection
+     *
+     * A collection runs at the start of a top level operation once the unique table holds
+     * threshold nodes. If most nodes survive, the next collection waits until the table
+     * doubled, so a large live set does not trigger a collection on every operation.
+     *
+     * @param threshold number of nodes that triggers a collection, 0 disables it
+     * @author Victor Herbert
+     */
+    void Manager::setGarbageCollectionThreshold(size_t threshold){
+        gc_threshold = threshold;
+        gc_next = threshold;
+    }
+
+    /**
+     * @brief mark and sweep garbage collection
+     *
+     * Marks the nodes reachable from the variables, the registered roots and the given
+     * operands, then moves every other node slot to the free list. The unique table and
+     * the computed table forget the freed nodes before their slots can be reused.
+     *
+     * @param operands additional roots, the operands of the running operation
+     * @return size_t number of freed nodes
+     * @author Victor Herbert
+     */
+    size_t Manager::markAndSweep(std::initializer_list<BDD_ID> operands){
+        std::vector<BDD_ID> stack(operands);
+
+        nodes[FALSE_ADDRESS].flags |= StoredNode::MARKED;
+        nodes[TRUE_ADDRESS].flags |= StoredNode::MARKED;
+        for(BDD_ID id = 2; id < nodes.size(); id++)
+            if(isVariable(id))
+                stack.push_back(id);
+        for(const auto &root : root_refs)
+            stack.push_back(root.first);
+
+        while(!stack.empty()){
+            StoredNode &node = nodes[nodeIndex(stack.back())];
+            stack.pop_back();
+            if(node.flags & StoredNode::MARKED)
+                continue;
+            node.flags |= StoredNode::MARKED;
+            stack.push_back(node.low);
+            stack.push_back(node.high);
+        }
+
+        // descending, so that the lowest slots are reused first
+        size_t freed = 0;
+        for(BDD_ID id = nodes.size() - 1; id > TRUE_ADDRESS; id--){
+            if(nodes[id].flags & (StoredNode::MARKED | StoredNode::FREE))
+                continue;
+
+            unique_table.erase(id, nodes);
+            nodes[id].flags = StoredNode::FREE;
+            free_slots.push_back(id);
+            labels.erase(id);
+            labels.erase(id | COMPLEMENT_BIT);
+            freed++;
+        }
+
+        computed_table.purge([this](BDD_ID id){
+            return (nodes[nodeIndex(id)].flags & StoredNode::MARKED) != 0;
+        });
+
+        for(StoredNode &node : nodes)
+            node.flags &= ~StoredNode::MARKED;
+
+        return freed;
+    }
+
+    Manager::OperationScope::OperationScope(Manager &manager, std::initializer_list<BDD_ID> operands) : manager(manager){
+        if(manager.operation_depth == 0 && manager.gc_threshold != 0 && manager.uniqueTableSize() >= manager.gc_next){
+            manager.markAndSweep(operands);
+            manager.gc_next = std::max(manager.gc_threshold, 2 * manager.uniqueTableSize());
+        }
+        if(manager.operation_depth == 0 && manager.reorder_threshold != 0 && manager.uniqueTableSize() >= manager.reorder_next){
+            manager.sift(operands);
+            manager.reorder_next = std::max(manager.reorder_threshold, 2 * manager.uniqueTableSize());
+        }
+        manager.operation_depth++;
+    }
+
+    Manager::OperationScope::~OperationScope(){
+        manager.operation_depth--;
+    }
+
     /**
      * @brief returns a pointer for the True node
      *
@@ -105,7 +354,69 @@ namespace ClassProject {
      * @author Victor Herbert
      */
     bool Manager::isVariable(BDD_ID x){
-        return nodes[x].topVar == x && !isConstant(x);
+        return !(x & COMPLEMENT_BIT) && x < nodes.size() && nodes[x].topVar == x && !isConstant(x);
+    }
+
+    /**
+     * @brief Checks if a given id refers to an existing node
+     *
+     * @return bool stating if the id (complemented or not) is known by the manager
+     * @author Victor Herbert
+     */
+    bool Manager::isValid(BDD_ID f){
+        BDD_ID idx = nodeIndex(f);
+        return idx < nodes.size() && !isFree(idx) && !(f & COMPLEMENT_BIT && isConstant(idx));
+    }
+
+    /**
+     * @brief Checks if a node slot was released by the garbage collection
+     *
+     * @return bool stating if the slot is waiting in the free list
+     * @author Victor Herbert
+     */
+    bool Manager::isFree(BDD_ID f){
+        return (nodes[nodeIndex(f)].flags & StoredNode::FREE) != 0;
+    }
+
+    /**
+     * @brief Checks if an edge is complemented
+     *
+     * The false terminal counts as the complement of the true terminal, so a
+     * regular edge never points to false.
+     *
+     * @return bool stating if the edge is complemented
+     * @author Victor Herbert
+     */
+    bool Manager::isComplement(BDD_ID f){
+        return (f & COMPLEMENT_BIT) || f == FALSE_ADDRESS;
+    }
+
+    /**
+     * @brief Flips the complement attribute of an edge
+     *
+     * @return BDD_ID of the negated function
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::complement(BDD_ID f){
+        return f <= TRUE_ADDRESS ? f ^ TRUE_ADDRESS : f ^ COMPLEMENT_BIT;
+    }
+
+    /**
+     * @brief returns the index of the node an edge points to
+     *
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::nodeIndex(BDD_ID f){
+        return f & ~COMPLEMENT_BIT;
+    }
+
+    /**
+     * @brief returns the level of the top variable of f, constants are below every variable
+     *
+     * @author Victor Herbert
+     */
+    Level Manager::level(BDD_ID f){
+        return nodes[nodeIndex(f)].level;
     }
 
     /**
@@ -125,9 +436,13 @@ namespace ClassProject {
     * @author Victor Herbert
     */
     BDD_ID Manager::createVar(const std::string &label){
-        BDD_ID id = addNode({
-            .low=FALSE_ADDRESS, .high=TRUE_ADDRESS, .topVar=nodes.size()
-        });
+        if(level_to_var.size() >= CONSTANT_LEVEL)
+            throw std::length_error("too many variables for the node layout");
+
+        // a new variable goes below all others; it never reuses a freed slot, so ids still grow
+        Node var = {.low=FALSE_ADDRESS, .high=TRUE_ADDRESS, .topVar=nodes.size()};
+        BDD_ID id = storeNode(var, level_to_var.size(), unique_table.lookup(var, nodes));
+        level_to_var.push_back(id);
         labels[id] = label;
         return id;
     }
@@ -140,18 +455,75 @@ namespace ClassProject {
      * @author Victor Herbert
      */
     BDD_ID Manager::addNode(Node node){
-        if(unique_table.find(node) == unique_table.end()){
-            nodes.push_back(node);
-            unique_table[node] = nodes.size()-1;
+        // canonical form: the high edge is always regular, the complement goes to the parent edge
+        if(isComplement(node.high)){
+            return complement(addNode({
+                .low=complement(node.low), .high=complement(node.high), .topVar=node.topVar
+            }));
         }
-        return unique_table[node];
+
+        NodeIndex &slot = unique_table.lookup(node, nodes);
+        if(slot != UniqueTable::EMPTY)
+            return slot;
+
+        return newNode(node, nodes[node.topVar].level, slot);
+    }
+
+    /**
+     * @brief Stores a node which is known not to be in the unique table, reusing a freed slot if possible
+     *
+     * @param node to be stored
+     * @param level of the top variable of the node
+     * @param slot empty unique table slot returned by the lookup of node
+     * @return BDD_ID of the new node
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::newNode(Node node, Level level, NodeIndex &slot){
+        if(free_slots.empty())
+            return storeNode(node, level, slot);
+
+        BDD_ID id = free_slots.back();
+        free_slots.pop_back();
+        nodes[id] = {
+            .low = (NodeIndex) node.low, .high = (NodeIndex) node.high,
+            .topVar = (NodeIndex) node.topVar, .level = level, .flags = 0
+        };
+        slot = id;
+        unique_table.inserted(nodes);
+        STAT(counters.peakNodes = std::max(counters.peakNodes, unique_table.size()));
+        return id;
+    }
+
+    /**
+     * @brief Appends a node which is known not to be in the unique table
+     *
+     * @param node to be stored
+     * @param level of the top variable of the node
+     * @param slot empty unique table slot returned by the lookup of node
+     * @return BDD_ID of the new node
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::storeNode(Node node, Level level, NodeIndex &slot){
+        // the highest bit of an edge is the complement attribute
+        if(nodes.size() >= COMPLEMENT_BIT)
+            throw std::length_error("too many nodes for the node layout");
+
+        BDD_ID id = nodes.size();
+        nodes.push_back({
+            .low = (NodeIndex) node.low, .high = (NodeIndex) node.high,
+            .topVar = (NodeIndex) node.topVar, .level = level, .flags = 0
+        });
+        slot = id;
+        unique_table.inserted(nodes);
+        STAT(counters.peakNodes = std::max(counters.peakNodes, unique_table.size()));
+        return id;
     }
 
     /**
      * @brief If Then Else routine
      *
      * i t + ~i e
-     * Performs the IF Then Else recursive algorithm, adding nodes on demand
+     * Performs the IF Then Else algorithm, adding nodes on demand
      *
      * @param i ID of the If node
      * @param t ID of the Then node
@@ -160,69 +532,342 @@ namespace ClassProject {
      * @author Victor Herbert
      */
     BDD_ID Manager::ite(BDD_ID i, BDD_ID t, BDD_ID e){
-        if(i == True()) return t;
-        if(i == False()) return e;
-        if(t == True() and e == False()) return i;
-        if(t == e) return t;
-
-        if(t == 0 and e == 1) count++;
-
-        // standard triples (excluding complements)        
-        if(isExpression(t)){
-            // ite(F, G, F) == ite(F, G, 0) 
-            if(i == e){
-                e = False();                
-            }
+        STAT(counters.ite++);
+        return apply(ComputedTable::ITE, i, t, e);
+    }
 
-            // ite(F, G, 0) == ite(G, F, 0)
-            if(e == False()){
-                BDD_ID temp;
-                if(topVar(t) < topVar(i) || (topVar(t) == topVar(i) && t < i)){
-                    temp = i;
-                    i = t;
-                    t = temp;                    
-                }
-            }  
-        }else if (isExpression(e)){
-            // ite(F, 1, G) == ite(G, 1, F)
-            // F is chosen to be the minimum between F and G based on the order topVar,id
-            if(t == True()){
-                BDD_ID temp;
-                if(topVar(e) < topVar(i) || (topVar(e) == topVar(i) && t < i)){
-                    temp = i;
-                    i = e;
-                    e = temp;                    
+    /**
+     * @brief Apply engine shared by ite and the binary kernels
+     *
+     * The recursion over the top variable is unrolled onto an explicit work stack, so
+     * the depth of the BDDs is not bounded by the call stack. Every pending call waits
+     * on the stack until the results of both of its cofactors are available. Binary
+     * operations pass a constant as h, which never provides the top variable.
+     *
+     * @param op operation, selects the terminal cases and the computed table tag
+     * @return BDD_ID of the result
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::apply(ComputedTable::Operation op, BDD_ID f, BDD_ID g, BDD_ID h){
+        OperationScope scope(*this, {f, g, h});
+
+        apply_stack.clear();
+        BDD_ID result;
+        bool call = true;
+
+        while(true){
+            if(call){
+                bool negate;
+                if(!standardize(op, f, g, h, negate, result)){
+                    // constants sit on the lowest level, so they never provide the top variable
+                    BDD_ID top = f;
+                    if(level(g) < level(top))
+                        top = g;
+                    if(level(h) < level(top))
+                        top = h;
+
+                    apply_stack.push_back({.f=f, .g=g, .h=h, .top=topVar(top), .level=level(top), .negate=negate});
+                    STAT(counters.maxDepth = std::max(counters.maxDepth, apply_stack.size()));
+
+                    // descend into the positive cofactors first
+                    Level top_level = level(top);
+                    f = topCofactor(f, top_level, true);
+                    g = topCofactor(g, top_level, true);
+                    h = topCofactor(h, top_level, true);
+                    continue;
                 }
+                call = false;
             }
 
-            // ite(F, F, G) == ite(F, 1, G) 
-            if(i == t){
-                t = True();                
+            // result belongs to the call on top of the stack
+            if(apply_stack.empty())
+                return result;
+
+            ApplyFrame &frame = apply_stack.back();
+            if(!frame.high_done){
+                frame.high = result;
+                frame.high_done = true;
+                f = topCofactor(frame.f, frame.level, false);
+                g = topCofactor(frame.g, frame.level, false);
+                h = topCofactor(frame.h, frame.level, false);
+                call = true;
+                continue;
             }
+
+            BDD_ID node = frame.high == result ? result : addNode({.low=result, .high=frame.high, .topVar=frame.top});
+            computed_table.insert(op, frame.f, frame.g, frame.h, node);
+            result = frame.negate ? complement(node) : node;
+            apply_stack.pop_back();
+        }
+    }
+
+    /**
+     * @brief Terminal cases and operand normalization of the apply engine
+     *
+     * @param negate set if the result of the normalized call has to be complemented
+     * @param result receives the result if it is already known
+     * @return bool stating if the result is known, from a terminal case or the computed table
+     * @author Victor Herbert
+     */
+    bool Manager::standardize(ComputedTable::Operation op, BDD_ID &f, BDD_ID &g, BDD_ID &h, bool &negate, BDD_ID &result){
+        bool known;
+        switch(op){
+            case ComputedTable::AND:
+                known = standardAnd(f, g, result);
+                negate = false;
+                break;
+            case ComputedTable::XOR:
+                known = standardXor(f, g, negate, result);
+                break;
+            case ComputedTable::RESTRICT:
+                known = standardRestrict(f, g, negate, result);
+                break;
+            default:
+                known = standardTriple(f, g, h, negate, result);
+        }
+        STAT(counters.recursiveCalls++);
+        if(known){
+            STAT(counters.terminalCases++);
+            return true;
         }
 
-        Node node = {.low=t, .high=e, .topVar=i};
-        //TODO check if label matters for comparison
-        if(computed_table.find(node) == computed_table.end()){
-            BDD_ID top = topVar(i);
-            if(!isConstant(t))
-                top = std::min(top, topVar(t));
-            if(!isConstant(e))
-                top = std::min(top, topVar(e));
+        if(!computed_table.lookup(op, f, g, h, result))
+            return false;
 
-            BDD_ID high = ite(coFactorTrue(i,top), coFactorTrue(t,top), coFactorTrue(e,top));
-            BDD_ID low = ite(coFactorFalse(i,top), coFactorFalse(t,top), coFactorFalse(e,top));
+        if(negate)
+            result = complement(result);
+        return true;
+    }
 
-            if(high == low){
-                computed_table[node] = high;
+    /**
+     * @brief Brings an ite triple into its standard form
+     *
+     * Equivalent calls share a single computed table entry: i and t become regular
+     * edges, and the symmetric forms pick as i the operand that comes first in the
+     * (level, id) order.
+     *
+     * @param negate set if the result of the standard triple has to be complemented
+     * @param result receives the result of a terminal case
+     * @return bool stating if a terminal case was found
+     * @author Victor Herbert
+     */
+    bool Manager::standardTriple(BDD_ID &i, BDD_ID &t, BDD_ID &e, bool &negate, BDD_ID &result){
+        if(i == True()){ result = t; return true; }
+        if(i == False()){ result = e; return true; }
+
+        // ite(F, F, G) == ite(F, 1, G) and ite(F, ~F, G) == ite(F, 0, G)
+        if(t == i) t = True();
+        else if(t == complement(i)) t = False();
+
+        // ite(F, G, F) == ite(F, G, 0) and ite(F, G, ~F) == ite(F, G, 1)
+        if(e == i) e = False();
+        else if(e == complement(i)) e = True();
+
+        if(t == e){ result = t; return true; }
+        if(t == True() and e == False()){ result = i; return true; }
+        if(t == False() and e == True()){ result = complement(i); return true; }
+
+        // standard triples
+        BDD_ID temp;
+        bool swapped = false;
+        if(t == True()){
+            // ite(F, 1, G) == ite(G, 1, F)
+            if(precedes(e, i)){
+                temp = i; i = e; e = temp; swapped = true;
+            }
+        }else if(e == False()){
+            // ite(F, G, 0) == ite(G, F, 0)
+            if(precedes(t, i)){
+                temp = i; i = t; t = temp; swapped = true;
             }
-            else{
-                BDD_ID result = addNode({.low=low, .high=high, .topVar=top});
-                computed_table[node] = result;
+        }else if(t == False()){
+            // ite(F, 0, G) == ite(~G, 0, ~F)
+            if(precedes(e, i)){
+                temp = i; i = complement(e); e = complement(temp); swapped = true;
             }
+        }else if(e == True()){
+            // ite(F, G, 1) == ite(~G, ~F, 1)
+            if(precedes(t, i)){
+                temp = i; i = complement(t); t = complement(temp); swapped = true;
+            }
+        }else if(t == complement(e)){
+            // ite(F, G, ~G) == ite(G, F, ~F)
+            if(precedes(t, i)){
+                temp = i; i = t; t = temp; e = complement(temp); swapped = true;
+            }
+        }
+
+        // ite(~F, G, H) == ite(F, H, G)
+        bool inverted = isComplement(i);
+        if(inverted){
+            i = complement(i);
+            temp = t; t = e; e = temp;
+        }
+
+        // ite(F, ~G, H) == ~ite(F, G, ~H)
+        negate = isComplement(t);
+        if(negate){
+            t = complement(t);
+            e = complement(e);
+        }
+
+        STAT(if(swapped || inverted || negate) counters.standardTriples++);
+        return false;
+    }
+
+    /**
+     * @brief Terminal cases of f AND g, orders the operands since AND commutes
+     *
+     * @param result receives the result of a terminal case
+     * @return bool stating if a terminal case was found
+     * @author Victor Herbert
+     */
+    bool Manager::standardAnd(BDD_ID &f, BDD_ID &g, BDD_ID &result){
+        if(f == False() || g == False() || f == complement(g)){ result = False(); return true; }
+        if(f == True() || f == g){ result = g; return true; }
+        if(g == True()){ result = f; return true; }
+
+        if(g < f)
+            std::swap(f, g);
+        return false;
+    }
+
+    /**
+     * @brief Terminal cases of f XOR g
+     *
+     * The complement attributes are moved to the result, xor(~F, G) == ~xor(F, G),
+     * and the operands are ordered since XOR commutes.
+     *
+     * @param negate set if the result of the normalized call has to be complemented
+     * @param result receives the result of a terminal case
+     * @return bool stating if a terminal case was found
+     * @author Victor Herbert
+     */
+    bool Manager::standardXor(BDD_ID &f, BDD_ID &g, bool &negate, BDD_ID &result){
+        if(f == g){ result = False(); return true; }
+        if(f == complement(g)){ result = True(); return true; }
+        if(f == False()){ result = g; return true; }
+        if(g == False()){ result = f; return true; }
+        if(f == True()){ result = complement(g); return true; }
+        if(g == True()){ result = complement(f); return true; }
+
+        negate = false;
+        if(isComplement(f)){
+            f = complement(f);
+            negate = !negate;
+        }
+        if(isComplement(g)){
+            g = complement(g);
+            negate = !negate;
+        }
+
+        if(g < f)
+            std::swap(f, g);
+        return false;
+    }
+
+    /**
+     * @brief Terminal cases of restricting f by a cube
+     *
+     * Literals above the top variable of f are dropped and literals on its level select
+     * the child of f, until the cube starts below f. From there on the engine branches on
+     * the top variable of f. The complement attribute of f is moved to the result.
+     *
+     * @param cube conjunction of literals
+     * @param negate set if the result of the normalized call has to be complemented
+     * @param result receives the result of a terminal case
+     * @return bool stating if a terminal case was found
+     * @author Victor Herbert
+     */
+    bool Manager::standardRestrict(BDD_ID &f, BDD_ID &cube, bool &negate, BDD_ID &result){
+        while(!isConstant(f) && cube != True() && level(cube) <= level(f)){
+            if(level(cube) == level(f))
+                f = low(cube) == False() ? high(f) : low(f);
+            cube = cubeRest(cube);
+        }
+
+        if(isConstant(f) || cube == True()){
+            result = f;
+            return true;
+        }
+
+        negate = isComplement(f);
+        if(negate)
+            f = complement(f);
+        return false;
+    }
+
+    /**
+     * @brief Terminal cases of the relational product exists cube: f g
+     *
+     * Plain quantification passes g = 1. Variables of the cube above the top variables
+     * of f and g occur in neither of them and are dropped, the operands are ordered
+     * since AND commutes, then the computed table is searched.
+     *
+     * @param result receives the result if it is already known
+     * @return bool stating if the result is known
+     * @author Victor Herbert
+     */
+    bool Manager::standardAndExists(BDD_ID &f, BDD_ID &g, BDD_ID &cube, BDD_ID &result){
+        if(f == False() || g == False() || f == complement(g)){
+            STAT(counters.terminalCases++);
+            result = False();
+            return true;
+        }
+        if(f == True() || f == g){ f = g; g = True(); }
+        if(g == True() && isConstant(f)){
+            STAT(counters.terminalCases++);
+            result = f;
+            return true;
+        }
+
+        Level top = std::min(level(f), level(g));
+        while(cube != True() && level(cube) < top)
+            cube = cubeRest(cube);
+
+        if(cube == True()){
+            STAT(counters.terminalCases++);
+            result = g == True() ? f : and2(f, g);
+            return true;
         }
 
-        return computed_table[node];
+        if(g != True() && g < f)
+            std::swap(f, g);
+
+        return computed_table.lookup(ComputedTable::AND_EXISTS, f, g, cube, result);
+    }
+
+    /**
+     * @brief Cube without its top literal
+     *
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::cubeRest(BDD_ID cube){
+        return low(cube) == False() ? high(cube) : low(cube);
+    }
+
+    /**
+     * @brief Cofactor of f with respect to the variable on level top
+     *
+     * f must not lie above top, so the cofactor is either f itself or one of its children
+     *
+     * @param positive selects the positive or the negative cofactor
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::topCofactor(BDD_ID f, Level top, bool positive){
+        if(level(f) != top)
+            return f;
+        return positive ? high(f) : low(f);
+    }
+
+    /**
+     * @brief Order used to pick the representative of symmetric ite triples
+     *
+     * @return bool stating if f comes before g in the (level, id) order
+     * @author Victor Herbert
+     */
+    bool Manager::precedes(BDD_ID f, BDD_ID g){
+        return level(f) < level(g) || (level(f) == level(g) && nodeIndex(f) < nodeIndex(g));
     }
 
     /**
@@ -259,7 +904,8 @@ namespace ClassProject {
      * @author Victor Herbert
      */
     BDD_ID Manager::and2(BDD_ID a, BDD_ID b){
-        BDD_ID id = ite(a,b, 0);
+        STAT(counters.and2++);
+        BDD_ID id = apply(ComputedTable::AND, a, b, False());
         #ifdef UPDATE_LABEL
         updateNodeLabel(id, a, b, "and2");
         #endif
@@ -275,7 +921,9 @@ namespace ClassProject {
      * @author Victor Herbert
      */
     BDD_ID Manager::or2(BDD_ID a, BDD_ID b){
-        BDD_ID id = ite(a, 1, b);
+        STAT(counters.and2++);
+        // a + b == ~(~a ~b)
+        BDD_ID id = complement(apply(ComputedTable::AND, complement(a), complement(b), False()));
         #ifdef UPDATE_LABEL
         updateNodeLabel(id, a, b, "or2");
         #endif
@@ -292,7 +940,8 @@ namespace ClassProject {
      * @author Victor Herbert
      */
     BDD_ID Manager::xor2(BDD_ID a, BDD_ID b){
-        BDD_ID id = ite(a,neg(b), b);
+        STAT(counters.xor2++);
+        BDD_ID id = apply(ComputedTable::XOR, a, b, False());
         #ifdef UPDATE_LABEL
         updateNodeLabel(id, a, b, "xor2");
         #endif
@@ -303,15 +952,17 @@ namespace ClassProject {
     /**
      * @brief creates a node that represents the negated version of a node
      *
+     * Negation only flips the complement attribute of the edge, no node is visited
+     *
      * @param a operand
      * @return BDD_ID of the node which encapsulates the operation
      * @author Victor Herbert
      */
     BDD_ID Manager::neg(BDD_ID a){
-        BDD_ID id = ite(a, 0, 1);
+        BDD_ID id = complement(a);
         #ifdef UPDATE_LABEL
-        if(nodes[id].label == "")
-            nodes[id].label = "~" + nodes[a].label;
+        if(labels.find(id) == labels.end())
+            labels[id] = "~" + labels[a];
         #endif
 
         return id;
@@ -326,7 +977,8 @@ namespace ClassProject {
      * @author Victor Herbert
      */
     BDD_ID Manager::nand2(BDD_ID a, BDD_ID b){
-        BDD_ID id = ite(a,neg(b), 1);
+        STAT(counters.and2++);
+        BDD_ID id = complement(apply(ComputedTable::AND, a, b, False()));
         #ifdef UPDATE_LABEL
         updateNodeLabel(id, a, b, "nand2");
         #endif
@@ -343,7 +995,8 @@ namespace ClassProject {
      * @author Victor Herbert
      */
     BDD_ID Manager::nor2(BDD_ID a, BDD_ID b){
-        BDD_ID id = ite(a, 0, neg(b));
+        STAT(counters.and2++);
+        BDD_ID id = apply(ComputedTable::AND, complement(a), complement(b), False());
         #ifdef UPDATE_LABEL
         updateNodeLabel(id, a, b, "nor2");
         #endif
@@ -360,7 +1013,8 @@ namespace ClassProject {
      * @author Victor Herbert
      */
     BDD_ID Manager::xnor2(BDD_ID a, BDD_ID b){
-        BDD_ID id = ite(a,b, neg(b));
+        STAT(counters.xor2++);
+        BDD_ID id = complement(apply(ComputedTable::XOR, a, b, False()));
         #ifdef UPDATE_LABEL
         updateNodeLabel(id, a, b, "xnor2");
         #endif
@@ -369,61 +1023,559 @@ namespace ClassProject {
     }
 
     /**
-     * @brief Breath first travel of the tree starting from node
+     * @brief Creates an human readable visualization of the OBDD
      *
-     * @param root node from which the traversal starts
-     * @param order output vector of the traversal in postorder
-     * @param marc vector cointaning which nodes have been visited
+     * @param filepath of the output
+     * @param root of the subtree to be printed
      *
+     * Creates a Mermaid diagram of the desired subtree in a markdown file
      * @author Victor Herbert
      */
-    void Manager::bfs(BDD_ID root, std::vector<BDD_ID> &order, std::vector<bool> &marc){
-        if(!isConstant(root)){
-            order.push_back(root);
+    void Manager::visualizeBDD(std::string filepath, BDD_ID &root){
+        std::ofstream file;
+        file.open(filepath);
 
-            if(!marc[nodes[root].low]){
-                marc[nodes[root].low] = true;
-                bfs(nodes[root].low, order, marc);
-            }
+        std::vector<BDD_ID> order = findNodes(root);
+
+        file << "```mermaid\nstateDiagram-v2\n";
+
+        for (BDD_ID node : order){
+            if(isConstant(node))
+                continue;
+            file << node << " --> " << low(node) << ": 0\n";
+            file << node << " --> " << high(node) << ": 1\n";
+        }
+        file << "classDef leaf fill:white\nclass 1 leaf\nclass 0 leaf\n```";
+
+        file.close();
+    }
+
+
+    /**
+     * @brief Writes the node table, the variable labels and order and named roots to a binary file
+     *
+     * The ids are kept as they are, free slots included, so the roots stay valid after
+     * loading. Ids are stored as fixed width 64 bit values, which makes the file
+     * independent of the node layout the library was built with.
+     *
+     * @param filepath of the snapshot
+     * @param roots BDDs to be found again by name after loading
+     * @author Victor Herbert
+     */
+    void Manager::save(const std::string &filepath, const std::map<std::string, BDD_ID> &roots){
+        for(const auto &root : roots)
+            if(!isValid(root.second))
+                throw std::invalid_argument("unknown root " + root.first);
+
+        std::ofstream out(filepath, std::ios::binary);
+        if(!out.is_open())
+            throw std::runtime_error("unable to open snapshot file " + filepath);
+
+        out.write(Snapshot::MAGIC, sizeof(Snapshot::MAGIC));
+        writeValue<uint32_t>(out, Snapshot::VERSION);
+        writeValue<uint64_t>(out, nodes.size());
+        writeValue<uint64_t>(out, level_to_var.size());
+
+        // the node table goes out as a single block
+        std::vector<uint64_t> table;
+        table.reserve(3 * nodes.size());
+        for(const StoredNode &node : nodes){
+            bool free = node.flags & StoredNode::FREE;
+            table.push_back(free ? Snapshot::FREE : node.low);
+            table.push_back(free ? Snapshot::FREE : node.high);
+            table.push_back(free ? Snapshot::FREE : node.topVar);
+        }
+        out.write(reinterpret_cast<const char *>(table.data()), table.size() * sizeof(uint64_t));
+
+        for(BDD_ID x : level_to_var)
+            writeValue<uint64_t>(out, x);
+
+        writeValue<uint64_t>(out, labels.size());
+        for(const auto &label : labels){
+            writeValue<int64_t>(out, label.first);
+            writeString(out, label.second);
+        }
+
+        writeValue<uint64_t>(out, roots.size());
+        for(const auto &root : roots){
+            writeString(out, root.first);
+            writeValue<uint64_t>(out, root.second);
+        }
+
+        if(!out)
+            throw std::runtime_error("unable to write snapshot file " + filepath);
+    }
 
-            if(!marc[nodes[root].high]){
-                marc[nodes[root].high] = true;
-                bfs(nodes[root].high, order, marc);
+    /**
+     * @brief Replaces the contents of the manager by a snapshot written with save
+     *
+     * The node table is taken over as it is and the unique table is filled in a single
+     * pass over it, without searching for duplicates. Cached results are dropped.
+     *
+     * @param filepath of the snapshot
+     * @return std::map<std::string, BDD_ID> roots stored in the snapshot, by name
+     * @author Victor Herbert
+     */
+    std::map<std::string, BDD_ID> Manager::load(const std::string &filepath){
+        if(!root_refs.empty())
+            throw std::logic_error("cannot load a snapshot while BDDs are rooted");
+
+        std::ifstream in(filepath, std::ios::binary);
+        if(!in.is_open())
+            throw std::runtime_error("unable to open snapshot file " + filepath);
+
+        char magic[sizeof(Snapshot::MAGIC)];
+        if(!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), Snapshot::MAGIC))
+            throw std::runtime_error("not a BDD snapshot");
+        if(readValue<uint32_t>(in) != Snapshot::VERSION)
+            throw std::runtime_error("unsupported snapshot version");
+
+        uint64_t node_count = readValue<uint64_t>(in);
+        uint64_t var_count = readValue<uint64_t>(in);
+        if(node_count < 2 || node_count >= UniqueTable::EMPTY || var_count >= CONSTANT_LEVEL)
+            throw std::length_error("snapshot does not fit the node layout");
+
+        std::vector<uint64_t> table(3 * node_count);
+        if(!in.read(reinterpret_cast<char *>(table.data()), table.size() * sizeof(uint64_t)))
+            throw std::runtime_error("truncated snapshot");
+
+        std::vector<BDD_ID> order(var_count);
+        for(BDD_ID &x : order)
+            x = readValue<uint64_t>(in);
+
+        std::unordered_map<int, std::string> loaded_labels;
+        for(uint64_t i = readValue<uint64_t>(in); i > 0; i--){
+            int id = readValue<int64_t>(in);
+            loaded_labels[id] = readString(in);
+        }
+
+        std::map<std::string, BDD_ID> roots;
+        for(uint64_t i = readValue<uint64_t>(in); i > 0; i--){
+            std::string name = readString(in);
+            roots[name] = readValue<uint64_t>(in);
+        }
+
+        // levels of the variables, every variable exactly once
+        std::vector<Level> levels(node_count, CONSTANT_LEVEL);
+        for(size_t i = 0; i < order.size(); i++){
+            BDD_ID x = order[i];
+            if(x < 2 || x >= node_count || table[3 * x + 2] != x || levels[x] != CONSTANT_LEVEL)
+                throw std::runtime_error("corrupt snapshot: invalid variable order");
+            levels[x] = i;
+        }
+
+        std::vector<StoredNode> loaded(node_count);
+        for(size_t id = 0; id < node_count; id++){
+            uint64_t low = table[3 * id], high = table[3 * id + 1], top = table[3 * id + 2];
+            if(top == Snapshot::FREE){
+                loaded[id] = {.low = 0, .high = 0, .topVar = 0, .level = CONSTANT_LEVEL, .flags = StoredNode::FREE};
+                continue;
             }
+            if(top >= node_count || (low & ~COMPLEMENT_BIT) >= node_count || high >= node_count)
+                throw std::runtime_error("corrupt snapshot: id out of range");
+            loaded[id] = {.low = (NodeIndex) low, .high = (NodeIndex) high, .topVar = (NodeIndex) top,
+                          .level = levels[top], .flags = 0};
+        }
+
+        if(!(loaded[FALSE_ADDRESS] == FALSE_NODE) || !(loaded[TRUE_ADDRESS] == TRUE_NODE))
+            throw std::runtime_error("corrupt snapshot: invalid constants");
+
+        // every other node lies above its children
+        for(size_t id = 2; id < node_count; id++){
+            const StoredNode &node = loaded[id];
+            if(node.flags & StoredNode::FREE)
+                continue;
+            const StoredNode &low = loaded[node.low & ~COMPLEMENT_BIT], &high = loaded[node.high];
+            bool variable = node.topVar == id;
+            if(node.level == CONSTANT_LEVEL || (low.flags | high.flags) & StoredNode::FREE
+               || (variable ? node.low != FALSE_ADDRESS || node.high != TRUE_ADDRESS
+                            : low.level <= node.level || high.level <= node.level))
+                throw std::runtime_error("corrupt snapshot: invalid node " + std::to_string(id));
+        }
+
+        for(const auto &root : roots){
+            BDD_ID id = root.second & ~COMPLEMENT_BIT;
+            if(id >= node_count || loaded[id].flags & StoredNode::FREE || (id != root.second && id <= TRUE_ADDRESS))
+                throw std::runtime_error("corrupt snapshot: unknown root " + root.first);
         }
+
+        nodes = std::move(loaded);
+        level_to_var = std::move(order);
+        labels = std::move(loaded_labels);
+
+        free_slots.clear();
+        for(BDD_ID id = nodes.size() - 1; id > TRUE_ADDRESS; id--)
+            if(nodes[id].flags & StoredNode::FREE)
+                free_slots.push_back(id);
+
+        unique_table.build(nodes);
+        computed_table.clear();
+        STAT(counters.peakNodes = std::max(counters.peakNodes, unique_table.size()));
+        return roots;
     }
 
+    /**
+     * @brief returns the position of a variable in the variable order
+     *
+     * @param x ID of a variable
+     * @return size_t level of x, 0 being the top of every BDD
+     * @author Victor Herbert
+     */
+    size_t Manager::getLevel(BDD_ID x){
+        if(!isVariable(x))
+            throw std::invalid_argument("level of a non variable node requested");
+        return nodes[x].level;
+    }
 
     /**
-     * @brief Creates an human readable visualization of the OBDD
+     * @brief returns the variable placed at a given level
      *
-     * @param filepath of the output
-     * @param root of the subtree to be printed
+     * @param level position in the variable order
+     * @return BDD_ID ID of the variable
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::varAtLevel(size_t level){
+        return level_to_var.at(level);
+    }
+
+    /**
+     * @brief returns all variables, from the top level to the bottom one
      *
-     * Creates a Mermaid diagram of the desired subtree in a markdown file
+     * @return std::vector<BDD_ID>
      * @author Victor Herbert
      */
-    void Manager::visualizeBDD(std::string filepath, BDD_ID &root){
-        std::ofstream file;
-        file.open(filepath);
+    std::vector<BDD_ID> Manager::getVariableOrder(){
+        return level_to_var;
+    }
 
-        std::vector<bool> marc (nodes.size(), false);
-        std::vector<BDD_ID> order;
-        order.reserve(nodes.size());
+    /**
+     * @brief places the variables in the given order, the first one on top
+     *
+     * Without expressions the variables are simply relabeled. Otherwise the order is
+     * reached by swapping adjacent levels, which keeps the ids and functions of the
+     * nodes. Only with the garbage collection enabled, the nodes that are not rooted are
+     * freed on the way, like in a collection.
+     *
+     * @param order permutation of all variables
+     * @author Victor Herbert
+     */
+    void Manager::setVariableOrder(const std::vector<BDD_ID> &order){
+        if(order.size() != level_to_var.size())
+            throw std::invalid_argument("order must contain every variable");
+
+        std::vector<bool> seen(nodes.size(), false);
+        for(BDD_ID x : order){
+            if(!isVariable(x) || seen[x])
+                throw std::invalid_argument("order must be a permutation of the variables");
+            seen[x] = true;
+        }
 
-        bfs(root, order, marc);
+        bool expressions = false;
+        for(BDD_ID id = 2; id < nodes.size() && !expressions; id++)
+            expressions = !isFree(id) && !isVariable(id);
 
-        file << "```mermaid\nstateDiagram-v2\n";
+        if(!expressions){
+            level_to_var = order;
+            for(size_t level = 0; level < order.size(); level++)
+                nodes[order[level]].level = level;
+            return;
+        }
 
-        for (BDD_ID node : order){
-            file << node << " --> " << nodes[node].low << ": 0\n";
-            file << node << " --> " << nodes[node].high << ": 1\n";
+        if(gc_threshold != 0)
+            markAndSweep({});
+        ReorderState state;
+        startReorder(state, {});
+        for(size_t level = 0; level < order.size(); level++)
+            while(nodes[order[level]].level > level)
+                swapLevels(state, nodes[order[level]].level - 1);
+        computed_table.clear();
+    }
+
+    /**
+     * @brief reorders the variables by sifting to reduce the number of nodes
+     *
+     * Every variable, the ones with the most nodes first, is moved through all levels
+     * and left where the BDDs were smallest. The ids of the live BDDs stay valid. Only
+     * with the garbage collection enabled, the nodes that are not rooted are freed like
+     * in a collection, otherwise every node is kept.
+     *
+     * @return size_t number of nodes after reordering
+     * @author Victor Herbert
+     */
+    size_t Manager::reorder(){
+        return sift({});
+    }
+
+    /**
+     * @brief enables the automatic reordering
+     *
+     * Sifting runs at the start of a top level operation once the unique table holds
+     * threshold nodes, the next run waits until the table doubled in size.
+     *
+     * @param threshold number of nodes that triggers a reordering, 0 disables it
+     * @author Victor Herbert
+     */
+    void Manager::setReorderThreshold(size_t threshold){
+        reorder_threshold = threshold;
+        reorder_next = threshold;
+    }
+
+    /**
+     * @brief bounds the effort spent on sifting a single variable
+     *
+     * @param max_growth a variable stops moving in one direction once the BDDs grow
+     * beyond max_growth times the best size seen
+     * @param max_seconds_per_var time after which a variable is put back to its best
+     * level, 0 for no limit
+     * @author Victor Herbert
+     */
+    void Manager::setReorderLimits(double max_growth, double max_seconds_per_var){
+        reorder_max_growth = max_growth;
+        reorder_time_limit = max_seconds_per_var;
+    }
+
+    /**
+     * @brief sets up reference counts and level lists for a reordering run
+     *
+     * Variables, registered roots and the operands of the running operation hold an
+     * external reference. With the garbage collection disabled the caller may hold any
+     * id, so every node holds one and nothing that exists now is freed.
+     *
+     * @author Victor Herbert
+     */
+    void Manager::startReorder(ReorderState &state, std::initializer_list<BDD_ID> operands){
+        state.refs.assign(nodes.size(), 0);
+        state.level_nodes.assign(level_to_var.size(), {});
+
+        for(BDD_ID id = 2; id < nodes.size(); id++){
+            if(isFree(id))
+                continue;
+            state.refs[nodeIndex(nodes[id].low)]++;
+            state.refs[nodeIndex(nodes[id].high)]++;
+            state.level_nodes[nodes[id].level].push_back(id);
+            if(isVariable(id) || gc_threshold == 0)
+                state.refs[id]++;
         }
-        file << "classDef leaf fill:white\nclass 1 leaf\nclass 0 leaf\n```";
+        for(const auto &root : root_refs)
+            state.refs[root.first]++;
+        for(BDD_ID operand : operands)
+            state.refs[nodeIndex(operand)]++;
+    }
 
-        file.close();
+    /**
+     * @brief Rudell's sifting over all variables
+     *
+     * @param operands additional roots, the operands of the running operation
+     * @return size_t number of nodes after reordering
+     * @author Victor Herbert
+     */
+    size_t Manager::sift(std::initializer_list<BDD_ID> operands){
+        if(gc_threshold != 0)
+            markAndSweep(operands);
+
+        ReorderState state;
+        startReorder(state, operands);
+
+        std::vector<BDD_ID> vars = level_to_var;
+        std::stable_sort(vars.begin(), vars.end(), [this, &state](BDD_ID a, BDD_ID b){
+            return state.level_nodes[nodes[a].level].size() > state.level_nodes[nodes[b].level].size();
+        });
+
+        for(BDD_ID var : vars)
+            siftVariable(state, var);
+
+        computed_table.clear();
+        return unique_table.size();
     }
 
+    /**
+     * @brief moves a variable to the level where the BDDs are smallest
+     *
+     * The variable first travels to the nearer end of the order, then to the other
+     * end, and finally back to the best level seen on the way.
+     *
+     * @author Victor Herbert
+     */
+    void Manager::siftVariable(ReorderState &state, BDD_ID var){
+        size_t bottom = level_to_var.size() - 1;
+        size_t level = nodes[var].level;
+        size_t best_level = level;
+        size_t best_size = unique_table.size();
+
+        auto start = std::chrono::steady_clock::now();
+        auto timeout = [this, &start](){
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            return reorder_time_limit > 0 && elapsed.count() > reorder_time_limit;
+        };
+
+        bool down_first = bottom - level < level;
+        for(int pass = 0; pass < 2; pass++){
+            bool down = (pass == 0) == down_first;
+            while(!timeout() && (down ? level < bottom : level > 0)){
+                if(down)
+                    swapLevels(state, level++);
+                else
+                    swapLevels(state, --level);
+
+                size_t size = unique_table.size();
+                if(size < best_size){
+                    best_size = size;
+                    best_level = level;
+                }else if(size > reorder_max_growth * best_size){
+                    break;
+                }
+            }
+        }
+
+        while(level < best_level)
+            swapLevels(state, level++);
+        while(level > best_level)
+            swapLevels(state, --level);
+    }
+
+    /**
+     * @brief swaps the variables of two adjacent levels in place
+     *
+     * A node of the upper variable x with a child labeled by the lower variable y is
+     * rewritten as a node of y whose children are (new) nodes of x, so it keeps its id
+     * and function. Nodes without such a child only change their level. Nodes of y
+     * which lose their last reference are freed.
+     *
+     * @param level upper of the two levels
+     * @author Victor Herbert
+     */
+    void Manager::swapLevels(ReorderState &state, size_t level){
+        BDD_ID x = level_to_var[level];
+        BDD_ID y = level_to_var[level + 1];
+
+        std::vector<BDD_ID> x_nodes = takeLevel(state, level);
+        std::vector<BDD_ID> y_nodes = takeLevel(state, level + 1);
+        std::vector<BDD_ID> &upper = state.level_nodes[level];
+        std::vector<BDD_ID> &lower = state.level_nodes[level + 1];
+        upper.clear();
+        lower.clear();
+
+        std::swap(level_to_var[level], level_to_var[level + 1]);
+
+        for(BDD_ID id : y_nodes){
+            nodes[id].level = level;
+            upper.push_back(id);
+        }
+
+        for(BDD_ID f : x_nodes){
+            BDD_ID f1 = nodes[f].high;
+            BDD_ID f0 = nodes[f].low;
+            bool high_y = topVar(f1) == y;
+            bool low_y = topVar(f0) == y;
+
+            if(!high_y && !low_y){
+                nodes[f].level = level + 1;
+                lower.push_back(f);
+                continue;
+            }
+
+            // f = x ? (y ? f11 : f10) : (y ? f01 : f00) = y ? (x ? f11 : f01) : (x ? f10 : f00)
+            BDD_ID f11 = high_y ? high(f1) : f1;
+            BDD_ID f10 = high_y ? low(f1) : f1;
+            BDD_ID f01 = low_y ? high(f0) : f0;
+            BDD_ID f00 = low_y ? low(f0) : f0;
+
+            BDD_ID new_high = reorderNode(state, {.low=f01, .high=f11, .topVar=x}, level + 1);
+            BDD_ID new_low = reorderNode(state, {.low=f00, .high=f10, .topVar=x}, level + 1);
+            releaseNode(state, f1);
+            releaseNode(state, f0);
+
+            // f11 is regular because the high edge of f is, so f keeps a regular high edge
+            unique_table.erase(f, nodes);
+            nodes[f].low = new_low;
+            nodes[f].high = new_high;
+            nodes[f].topVar = y;
+            nodes[f].level = level;
+            unique_table.lookup(nodes[f].node(), nodes) = f;
+            unique_table.inserted(nodes);
+            upper.push_back(f);
+        }
+    }
+
+    /**
+     * @brief returns the live nodes of a level, without stale or repeated ids
+     *
+     * @author Victor Herbert
+     */
+    std::vector<BDD_ID> Manager::takeLevel(ReorderState &state, size_t level){
+        BDD_ID var = level_to_var[level];
+        std::vector<BDD_ID> level_nodes;
+
+        for(BDD_ID id : state.level_nodes[level]){
+            StoredNode &node = nodes[id];
+            if(node.flags & (StoredNode::FREE | StoredNode::MARKED) || node.topVar != var)
+                continue;
+            node.flags |= StoredNode::MARKED;
+            level_nodes.push_back(id);
+        }
+        for(BDD_ID id : level_nodes)
+            nodes[id].flags &= ~StoredNode::MARKED;
+
+        return level_nodes;
+    }
+
+    /**
+     * @brief find or add for the nodes created by a level swap, counting the new reference
+     *
+     * @param node to be found or added
+     * @param level of the top variable of the node
+     * @return BDD_ID of the (possibly reduced) node
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::reorderNode(ReorderState &state, Node node, Level level){
+        if(node.low == node.high){
+            state.refs[nodeIndex(node.low)]++;
+            return node.low;
+        }
+
+        if(isComplement(node.high)){
+            return complement(reorderNode(state, {
+                .low=complement(node.low), .high=complement(node.high), .topVar=node.topVar
+            }, level));
+        }
+
+        NodeIndex &slot = unique_table.lookup(node, nodes);
+        if(slot != UniqueTable::EMPTY){
+            state.refs[slot]++;
+            return slot;
+        }
+
+        state.refs[nodeIndex(node.low)]++;
+        state.refs[nodeIndex(node.high)]++;
+
+        BDD_ID id = newNode(node, level, slot);
+        state.refs.resize(nodes.size(), 0);
+        state.refs[id] = 1;
+        state.level_nodes[level].push_back(id);
+        return id;
+    }
+
+    /**
+     * @brief drops a reference, freeing the node and its descendants that become unreferenced
+     *
+     * @author Victor Herbert
+     */
+    void Manager::releaseNode(ReorderState &state, BDD_ID f){
+        std::vector<BDD_ID> stack = {nodeIndex(f)};
+
+        while(!stack.empty()){
+            BDD_ID id = stack.back();
+            stack.pop_back();
+            if(isConstant(id) || --state.refs[id] > 0)
+                continue;
+
+            stack.push_back(nodeIndex(nodes[id].low));
+            stack.push_back(nodeIndex(nodes[id].high));
+            unique_table.erase(id, nodes);
+            nodes[id].flags = StoredNode::FREE;
+            free_slots.push_back(id);
+        }
+    }
 
     /**
     * @brief returns the id of the top variable of the given node f
@@ -433,7 +1585,7 @@ namespace ClassProject {
     * @author Kamel Fakih
     */
     BDD_ID Manager::topVar(BDD_ID f){
-        return nodes[f].topVar;
+        return nodes[nodeIndex(f)].topVar;
     }
 
     /**
@@ -444,7 +1596,8 @@ namespace ClassProject {
     * @author Kamel Fakih
     */
     BDD_ID Manager::low(BDD_ID f){
-        return nodes[f].low;
+        BDD_ID low = nodes[nodeIndex(f)].low;
+        return (f & COMPLEMENT_BIT) ? complement(low) : low;
     }
 
     /**
@@ -455,7 +1608,8 @@ namespace ClassProject {
     * @author Kamel Fakih
     */
     BDD_ID Manager::high(BDD_ID f){
-        return nodes[f].high;
+        BDD_ID high = nodes[nodeIndex(f)].high;
+        return (f & COMPLEMENT_BIT) ? complement(high) : high;
     }
 
     /**
@@ -466,7 +1620,7 @@ namespace ClassProject {
     * @author Victor Herbert
     */
     Node Manager::node(BDD_ID f){
-        return nodes[f];
+        return {.low = low(f), .high = high(f), .topVar = topVar(f)};
     }
 
     /**
@@ -482,21 +1636,10 @@ namespace ClassProject {
     * @author Kamel Fakih
     */
     BDD_ID Manager::coFactorTrue(BDD_ID f, BDD_ID x){
-
-        BDD_ID fTopVar = topVar(f);
-        BDD_ID fHigh   = high(f);
-        BDD_ID fLow    = low(f);
-
-        if(isConstant(f) || isConstant(x) || fTopVar > x){
+        STAT(counters.coFactor++);
+        if(!isVariable(x))
             return f;
-        }
-        if(fTopVar == x){
-            return fHigh;
-        }else{
-            auto T = coFactorTrue(fHigh, x);
-            auto F = coFactorTrue(fLow, x);
-            return ite(fTopVar, T, F);
-        }
+        return apply(ComputedTable::RESTRICT, f, x, False());
     }
 
     /**
@@ -525,21 +1668,10 @@ namespace ClassProject {
     * @author Kamel Fakih
     */
     BDD_ID Manager::coFactorFalse(BDD_ID f, BDD_ID x){
-
-        BDD_ID fTopVar = topVar(f);
-        BDD_ID fHigh   = high(f);
-        BDD_ID fLow    = low(f);
-
-        if(isConstant(f) || isConstant(x) || fTopVar > x){
+        STAT(counters.coFactor++);
+        if(!isVariable(x))
             return f;
-        }
-        if(fTopVar == x){
-            return fLow;
-        }else{
-            auto T = coFactorFalse(fHigh, x);
-            auto F = coFactorFalse(fLow, x);
-            return ite(fTopVar, T, F);
-        }
+        return apply(ComputedTable::RESTRICT, f, complement(x), False());
     }
 
     /**
@@ -556,59 +1688,864 @@ namespace ClassProject {
         return coFactorFalse(f, topVar(f));
     }
 
+    /**
+     * @brief Checks if a node is a conjunction of literals
+     *
+     * Every node of a cube has one child that is the false node, the variables of the
+     * cube are those of the nodes, their polarity is given by the other child.
+     *
+     * @return bool stating if f is a cube, the true node being the empty cube
+     * @author Victor Herbert
+     */
+    bool Manager::isCube(BDD_ID f){
+        if(!isValid(f))
+            return false;
+        while(!isConstant(f)){
+            if(high(f) == False())
+                f = low(f);
+            else if(low(f) == False())
+                f = high(f);
+            else
+                return false;
+        }
+        return f == True();
+    }
+
+    /**
+     * @brief Builds the conjunction of the given literals
+     *
+     * @param literals variables or negated variables
+     * @return BDD_ID of the cube
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::makeCube(const std::vector<BDD_ID> &literals){
+        for(BDD_ID literal : literals)
+            if(!isVariable(nodeIndex(literal)))
+                throw std::invalid_argument("cube literals must be variables or negated variables");
+
+        // conjoin bottom-up, so every step only adds a node on top of the partial cube
+        std::vector<BDD_ID> sorted(literals);
+        std::sort(sorted.begin(), sorted.end(), [this](BDD_ID a, BDD_ID b){
+            return level(a) > level(b);
+        });
+
+        BDDHandle cube(*this, True());
+        for(BDD_ID literal : sorted)
+            cube = BDDHandle(*this, and2(literal, cube));
+        return cube;
+    }
+
+    /**
+     * @brief Restricts f to a partial assignment in a single traversal
+     *
+     * Every variable of the cube is replaced by the constant given by its polarity, so
+     * the cube x ~y yields f with x = 1 and y = 0. Intermediate results are cached.
+     *
+     * @param f function to be restricted
+     * @param cube conjunction of literals, see makeCube
+     * @return BDD_ID of the restricted function
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::restrict(BDD_ID f, BDD_ID cube){
+        STAT(counters.restrict++);
+        if(!isCube(cube))
+            throw std::invalid_argument("restriction must be given as a cube of literals");
+        return apply(ComputedTable::RESTRICT, f, cube, False());
+    }
+
+    /**
+     * @brief Existential quantification of the variables of a cube
+     *
+     * All variables are quantified in a single pass, see andExists.
+     * The polarity of the literals is ignored.
+     *
+     * @param f function to be quantified
+     * @param cube conjunction of the variables to be quantified, see makeCube
+     * @return BDD_ID of the quantified function
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::exists(BDD_ID f, BDD_ID cube){
+        return andExists(f, True(), cube);
+    }
+
+    /**
+     * @brief Relational product, the conjunction f g with the variables of a cube quantified
+     *
+     * Conjunction and quantification happen in the same recursion, so the conjunction
+     * itself is never built. It runs iteratively on its own work stack: below a quantified
+     * variable the two cofactors are combined with or2, and the negative cofactor is
+     * skipped when the positive one is already true. Results are cached per (f, g, cube).
+     *
+     * @param f operand
+     * @param g operand
+     * @param cube conjunction of the variables to be quantified, see makeCube
+     * @return BDD_ID of the quantified conjunction
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::andExists(BDD_ID f, BDD_ID g, BDD_ID cube){
+        STAT(counters.andExists++);
+        if(!isCube(cube))
+            throw std::invalid_argument("quantified variables must be given as a cube");
+
+        OperationScope scope(*this, {f, g, cube});
+
+        quantify_stack.clear();
+        BDD_ID result;
+        bool call = true;
+
+        while(true){
+            if(call){
+                STAT(counters.recursiveCalls++);
+                if(!standardAndExists(f, g, cube, result)){
+                    Level top = std::min(level(f), level(g));
+                    bool quantified = level(cube) == top;
+                    quantify_stack.push_back({.f=f, .g=g, .cube=cube, .top=topVar(level(f) == top ? f : g),
+                                              .level=top, .quantified=quantified});
+                    STAT(counters.maxDepth = std::max(counters.maxDepth, quantify_stack.size()));
+
+                    f = topCofactor(f, top, true);
+                    g = topCofactor(g, top, true);
+                    if(quantified)
+                        cube = cubeRest(cube);
+                    continue;
+                }
+                call = false;
+            }
+
+            // result belongs to the call on top of the stack
+            if(quantify_stack.empty())
+                return result;
+
+            QuantifyFrame &frame = quantify_stack.back();
+            if(!frame.high_done && !(frame.quantified && result == True())){
+                frame.high = result;
+                frame.high_done = true;
+                f = topCofactor(frame.f, frame.level, false);
+                g = topCofactor(frame.g, frame.level, false);
+                cube = frame.quantified ? cubeRest(frame.cube) : frame.cube;
+                call = true;
+                continue;
+            }
+
+            BDD_ID node;
+            if(!frame.high_done)
+                node = True();
+            else if(frame.quantified)
+                node = or2(frame.high, result);
+            else
+                node = frame.high == result ? result : addNode({.low=result, .high=frame.high, .topVar=frame.top});
+
+            computed_table.insert(ComputedTable::AND_EXISTS, frame.f, frame.g, frame.cube, node);
+            result = node;
+            quantify_stack.pop_back();
+        }
+    }
+
+    /**
+     * @brief Substitutes functions for variables of f, all at the same time
+     *
+     * Every node of f is visited once, children first, and rebuilt as ite(g, high, low)
+     * where g is the function substituted for its variable. When the substitution maps
+     * the support of f to variables in the same relative order, the nodes are instead
+     * relabeled directly, which needs no ite calls at all. This is the case for renaming
+     * a set of variables to another one that is ordered alike.
+     *
+     * @param f function to be substituted
+     * @param substitution maps variables to the functions that replace them
+     * @return BDD_ID of f with every mapped variable replaced
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::compose(BDD_ID f, const std::unordered_map<BDD_ID, BDD_ID> &substitution){
+        STAT(counters.compose++);
+        std::vector<BDDHandle> roots;
+        for(const auto &entry : substitution){
+            if(!isVariable(entry.first))
+                throw std::invalid_argument("only variables can be substituted");
+            if(!isValid(entry.second))
+                throw std::invalid_argument("unknown substitute");
+            roots.emplace_back(*this, entry.second);
+        }
+
+        OperationScope scope(*this, {f});
+
+        std::vector<BDD_ID> order = postOrder(f);
+        std::unordered_map<BDD_ID, BDD_ID> result_of;
+
+        auto substitute = [&substitution](BDD_ID x){
+            auto it = substitution.find(x);
+            return it == substitution.end() ? x : it->second;
+        };
+
+        // relabeling is possible if the substitutes are variables ordered like the support
+        std::vector<std::pair<Level, Level>> levels;
+        bool relabel = true;
+        for(BDD_ID node : order){
+            BDD_ID x = topVar(node);
+            relabel = relabel && isVariable(substitute(x));
+            levels.emplace_back(level(x), level(substitute(x)));
+        }
+
+        std::sort(levels.begin(), levels.end());
+        levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+        for(size_t i = 1; relabel && i < levels.size(); i++)
+            relabel = levels[i - 1].second < levels[i].second;
+
+        auto resolve = [&](BDD_ID x){
+            if(isConstant(x))
+                return x;
+            return isComplement(x) ? complement(result_of[nodeIndex(x)]) : result_of[x];
+        };
+
+        for(BDD_ID node : order){
+            BDD_ID high_result = resolve(high(node));
+            BDD_ID low_result = resolve(low(node));
+            BDD_ID x = substitute(topVar(node));
+            result_of[node] = relabel ? addNode({.low=low_result, .high=high_result, .topVar=x})
+                                      : ite(x, high_result, low_result);
+        }
+
+        return resolve(f);
+    }
+
+    /**
+     * @brief Regular nodes of f, every node after its children
+     *
+     * @author Victor Herbert
+     */
+    std::vector<BDD_ID> Manager::postOrder(BDD_ID f){
+        return postOrder(std::vector<BDD_ID>{f});
+    }
+
+    /**
+     * @brief Regular nodes of all roots, every node once and after its children
+     *
+     * @author Victor Herbert
+     */
+    std::vector<BDD_ID> Manager::postOrder(const std::vector<BDD_ID> &roots){
+        startVisit();
+        std::vector<BDD_ID> order;
+        std::vector<std::pair<BDD_ID, bool>> stack;
+        for(auto root = roots.rbegin(); root != roots.rend(); ++root)
+            stack.push_back({nodeIndex(*root), false});
+        while(!stack.empty()){
+            auto [node, expanded] = stack.back();
+            stack.pop_back();
+            if(isConstant(node))
+                continue;
+            if(expanded){
+                order.push_back(node);
+                continue;
+            }
+            if(!firstVisit(2 * node))
+                continue;
+            stack.push_back({node, true});
+            stack.push_back({nodeIndex(low(node)), false});
+            stack.push_back({nodeIndex(high(node)), false});
+        }
+        return order;
+    }
+
+    /**
+     * @brief Number of satisfying assignments of f over nVars variables
+     *
+     * The support of f must lie within the nVars variables. Every node is assigned the
+     * fraction of all assignments that satisfy it, bottom-up in a single pass. The
+     * fraction of the complement is kept alongside, so complemented edges never
+     * subtract two nearly equal numbers.
+     *
+     * @param f function to be counted
+     * @param nVars number of variables the assignments range over
+     * @return double count, which overflows to infinity beyond 2^1023, see satCountLog2
+     * @author Victor Herbert
+     */
+    double Manager::satCount(BDD_ID f, size_t nVars){
+        std::unordered_map<BDD_ID, std::pair<double, double>> fraction;
+        auto of = [&](BDD_ID x){
+            if(x == True())
+                return std::make_pair(1.0, 0.0);
+            if(x == False())
+                return std::make_pair(0.0, 1.0);
+            auto result = fraction[nodeIndex(x)];
+            return isComplement(x) ? std::make_pair(result.second, result.first) : result;
+        };
+
+        for(BDD_ID node : postOrder(f)){
+            auto h = of(high(node)), l = of(low(node));
+            fraction[node] = {(h.first + l.first) / 2, (h.second + l.second) / 2};
+        }
+        return std::ldexp(of(f).first, nVars);
+    }
+
+    /**
+     * @brief Binary logarithm of the number of satisfying assignments of f over nVars variables
+     *
+     * Same pass as satCount, but on the logarithms of the fractions, so neither huge
+     * counts nor deep BDDs leave the double range.
+     *
+     * @return double log2 of the count, -infinity for the false node
+     * @author Victor Herbert
+     */
+    double Manager::satCountLog2(BDD_ID f, size_t nVars){
+        const double NONE = -std::numeric_limits<double>::infinity();
+
+        // log2((2^a + 2^b) / 2)
+        auto average = [NONE](double a, double b){
+            if(a < b)
+                std::swap(a, b);
+            return b == NONE ? a - 1 : a + std::log2(1 + std::exp2(b - a)) - 1;
+        };
+
+        std::unordered_map<BDD_ID, std::pair<double, double>> fraction;
+        auto of = [&](BDD_ID x){
+            if(x == True())
+                return std::make_pair(0.0, NONE);
+            if(x == False())
+                return std::make_pair(NONE, 0.0);
+            auto result = fraction[nodeIndex(x)];
+            return isComplement(x) ? std::make_pair(result.second, result.first) : result;
+        };
+
+        for(BDD_ID node : postOrder(f)){
+            auto h = of(high(node)), l = of(low(node));
+            fraction[node] = {average(h.first, l.first), average(h.second, l.second)};
+        }
+        return of(f).first + nVars;
+    }
+
+    /**
+     * @brief Exact number of satisfying assignments of f over nVars variables
+     *
+     * Every node is assigned the number of assignments to the variables on its level
+     * and below that satisfy it, and the same number for its complement.
+     *
+     * @return BigUnsigned count
+     * @author Victor Herbert
+     */
+    BigUnsigned Manager::satCountExact(BDD_ID f, size_t nVars){
+        const size_t variables = level_to_var.size();
+        auto levelOf = [&](BDD_ID x){
+            return isConstant(x) ? variables : (size_t) level(x);
+        };
+
+        std::unordered_map<BDD_ID, std::pair<BigUnsigned, BigUnsigned>> count;
+        auto of = [&](BDD_ID x){
+            if(x == True())
+                return std::make_pair(BigUnsigned(1), BigUnsigned(0));
+            if(x == False())
+                return std::make_pair(BigUnsigned(0), BigUnsigned(1));
+            auto result = count[nodeIndex(x)];
+            return isComplement(x) ? std::make_pair(result.second, result.first) : result;
+        };
+
+        for(BDD_ID node : postOrder(f)){
+            auto h = of(high(node)), l = of(low(node));
+            // the levels skipped by an edge multiply its count
+            size_t level_h = levelOf(high(node)) - levelOf(node) - 1;
+            size_t level_l = levelOf(low(node)) - levelOf(node) - 1;
+            h.first <<= level_h;
+            h.second <<= level_h;
+            l.first <<= level_l;
+            l.second <<= level_l;
+            h.first += l.first;
+            h.second += l.second;
+            count[node] = h;
+        }
+
+        BigUnsigned result = of(f).first;
+        result <<= levelOf(f);
+        if(nVars >= variables)
+            result <<= nVars - variables;
+        else
+            result >>= variables - nVars;
+        return result;
+    }
+
+    /**
+     * @brief Picks one satisfying assignment of f along a single path
+     *
+     * @param cube receives the literals of the path, which can be passed to makeCube
+     * @return bool stating if f is satisfiable
+     * @author Victor Herbert
+     */
+    bool Manager::pickOneCube(BDD_ID f, std::vector<BDD_ID> &cube){
+        CubeIterator it(*this, f);
+        if(it.done())
+            return false;
+        cube = *it;
+        return true;
+    }
+
+    /**
+     * @brief Evaluates root on many assignments at once, see the multi-root variant
+     *
+     * @author Victor Herbert
+     */
+    std::vector<uint64_t> Manager::evaluateBatch(BDD_ID root, const std::vector<std::vector<uint64_t>> &assignments){
+        return evaluateBatch(std::vector<BDD_ID>{root}, assignments).front();
+    }
+
+    /**
+     * @brief Evaluates every root on many assignments in a single sweep over their nodes
+     *
+     * The assignments are bit-sliced: bit j of word w of assignments[x] is the value of
+     * variable x in assignment 64 w + j. Each node is evaluated on a whole block of
+     * words at once, children first, as (x AND high) OR (NOT x AND low), so a sweep
+     * handles BLOCK * 64 assignments without following any path. The nodes shared by
+     * several roots are evaluated once.
+     *
+     * @param roots functions to be evaluated
+     * @param assignments values of the variables, indexed by variable id, all with the same
+     * number of words; variables outside the support of the roots may be left empty
+     * @return std::vector<std::vector<uint64_t>> values of each root, bit-sliced the same way
+     * @author Victor Herbert
+     */
+    std::vector<std::vector<uint64_t>> Manager::evaluateBatch(const std::vector<BDD_ID> &roots,
+                                                              const std::vector<std::vector<uint64_t>> &assignments){
+        // one cache line of values per node
+        const size_t BLOCK = 8;
+
+        for(BDD_ID root : roots)
+            if(!isValid(root))
+                throw std::invalid_argument("unknown root");
+
+        size_t words = 0;
+        for(const std::vector<uint64_t> &values : assignments)
+            words = std::max(words, values.size());
+
+        // slot 0 holds the true node, slot i + 1 the i-th node of the order
+        std::vector<BDD_ID> order = postOrder(roots);
+        std::unordered_map<BDD_ID, size_t> slot_of;
+        slot_of.reserve(order.size());
+        for(size_t i = 0; i < order.size(); i++)
+            slot_of[order[i]] = i + 1;
+
+        // a complemented edge flips all bits of its target, high edges are always regular
+        auto edge = [&](BDD_ID f){
+            size_t slot = isConstant(f) ? 0 : slot_of.at(nodeIndex(f));
+            return std::make_pair(slot, isComplement(f) ? ~uint64_t(0) : 0);
+        };
+
+        struct Step{
+            const uint64_t *x;
+            size_t high, low;
+            uint64_t low_mask;
+        };
+        std::vector<Step> steps;
+        steps.reserve(order.size());
+        for(BDD_ID node : order){
+            BDD_ID x = topVar(node);
+            if(x >= assignments.size() || assignments[x].size() != words)
+                throw std::invalid_argument("no values for variable " + labels[x]);
+            auto low_edge = edge(low(node));
+            steps.push_back({.x = assignments[x].data(), .high = edge(high(node)).first,
+                             .low = low_edge.first, .low_mask = low_edge.second});
+        }
+
+        std::vector<std::vector<uint64_t>> results(roots.size(), std::vector<uint64_t>(words));
+        std::vector<uint64_t> values((order.size() + 1) * BLOCK);
+        for(size_t begin = 0; begin < words; begin += BLOCK){
+            size_t count = std::min(BLOCK, words - begin);
+            std::fill(values.begin(), values.begin() + BLOCK, ~uint64_t(0));
+
+            for(size_t i = 0; i < steps.size(); i++){
+                const Step &step = steps[i];
+                const uint64_t *x = step.x + begin;
+                const uint64_t *high = &values[step.high * BLOCK], *low = &values[step.low * BLOCK];
+                uint64_t *value = &values[(i + 1) * BLOCK];
+                for(size_t w = 0; w < count; w++)
+                    value[w] = (x[w] & high[w]) | (~x[w] & (low[w] ^ step.low_mask));
+            }
+
+            for(size_t r = 0; r < roots.size(); r++){
+                auto [slot, mask] = edge(roots[r]);
+                for(size_t w = 0; w < count; w++)
+                    results[r][begin + w] = values[slot * BLOCK + w] ^ mask;
+            }
+        }
+        return results;
+    }
+
+    /**
+     * @brief Number of nodes of f, not counting the constants
+     *
+     * @author Victor Herbert
+     */
+    size_t Manager::nodeCount(BDD_ID f){
+        return postOrder(f).size();
+    }
+
+    /**
+     * @brief Number of nodes of f, counting at most limit of them
+     *
+     * Stops as soon as limit nodes are found, so comparing a BDD against a size bound
+     * costs O(limit) instead of a traversal of the whole BDD.
+     *
+     * @param f function to be counted
+     * @param limit upper bound of the result
+     * @return size_t min(nodeCount(f), limit)
+     * @author Victor Herbert
+     */
+    size_t Manager::nodeCount(BDD_ID f, size_t limit){
+        startVisit();
+        size_t count = 0;
+        std::vector<BDD_ID> stack = {nodeIndex(f)};
+        while(!stack.empty() && count < limit){
+            BDD_ID node = stack.back();
+            stack.pop_back();
+            if(isConstant(node) || !firstVisit(2 * node))
+                continue;
+
+            count++;
+            stack.push_back(nodeIndex(low(node)));
+            stack.push_back(nodeIndex(high(node)));
+        }
+        return count;
+    }
+
+    /**
+     * @brief Reduces the operands with a binary kernel, always combining the two smallest BDDs
+     *
+     * Operands of equal size are combined in the order they were queued, which gives a
+     * balanced tree instead of a linear chain. The operands are rooted for the whole
+     * reduction, and no garbage is collected before it is finished.
+     *
+     * @param op AND or XOR
+     * @param operands functions to be combined
+     * @return BDD_ID of the combination, the neutral element for no operands
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::applyN(ComputedTable::Operation op, const std::vector<BDD_ID> &operands){
+        STAT(counters.naryOperations++);
+        std::vector<BDDHandle> roots;
+        for(BDD_ID f : operands){
+            if(!isValid(f))
+                throw std::invalid_argument("unknown operand");
+            roots.emplace_back(*this, f);
+        }
+
+        OperationScope scope(*this, {});
+
+        // with two operands there is nothing to schedule
+        if(operands.size() == 2)
+            return apply(op, operands[0], operands[1], False());
+
+        // (size, sequence, id), the smallest and oldest entry on top
+        typedef std::tuple<size_t, size_t, BDD_ID> Entry;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+        size_t sequence = 0;
+        for(BDD_ID f : operands)
+            queue.emplace(nodeCount(f), sequence++, f);
+
+        if(queue.empty())
+            return op == ComputedTable::AND ? True() : False();
+
+        while(queue.size() > 1){
+            BDD_ID f = std::get<2>(queue.top());
+            queue.pop();
+            BDD_ID g = std::get<2>(queue.top());
+            queue.pop();
+
+            BDD_ID result = apply(op, f, g, False());
+            if(op == ComputedTable::AND && result == False())
+                return result;
+
+            // the size only matters if there is still a choice to make
+            if(queue.size() == 1)
+                return apply(op, std::get<2>(queue.top()), result, False());
+            queue.emplace(nodeCount(result), sequence++, result);
+        }
+        return std::get<2>(queue.top());
+    }
+
+    /**
+     * @brief AND of any number of operands, see applyN
+     *
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::andN(const std::vector<BDD_ID> &operands){
+        return applyN(ComputedTable::AND, operands);
+    }
+
+    /**
+     * @brief OR of any number of operands, computed as ~andN(~operands)
+     *
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::orN(const std::vector<BDD_ID> &operands){
+        std::vector<BDD_ID> complemented;
+        for(BDD_ID f : operands)
+            complemented.push_back(complement(f));
+        return complement(applyN(ComputedTable::AND, complemented));
+    }
+
+    /**
+     * @brief XOR of any number of operands, see applyN
+     *
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::xorN(const std::vector<BDD_ID> &operands){
+        return applyN(ComputedTable::XOR, operands);
+    }
+
+    /**
+     * @brief Universal quantification of the variables of a cube
+     *
+     * Computed as ~exists(~f), so both share their computed table entries
+     *
+     * @param f function to be quantified
+     * @param cube conjunction of the variables to be quantified, see makeCube
+     * @return BDD_ID of the quantified function
+     * @author Victor Herbert
+     */
+    BDD_ID Manager::forall(BDD_ID f, BDD_ID cube){
+        return complement(exists(complement(f), cube));
+    }
+
     /**
      * @brief returns the set of all nodes that are reachable from root node
      * including itself
      *
-     *
-     * uses DFS algorithm
+     * Wrapper of the vector based findNodes
      *
      * @param root
      * @param nodes_of_root
      * @author Kamel Fakih
      */
     void Manager::findNodes(const BDD_ID &root, std::set<BDD_ID> &nodes_of_root){
-        std::unordered_set<BDD_ID> discovered = std::unordered_set<BDD_ID>();
-        findNodesDFS(root, nodes_of_root, discovered);
-    }
-
-    void Manager::findNodesDFS(const BDD_ID &root, std::set<BDD_ID> &nodes_of_root, std::unordered_set<BDD_ID> &discovered){
-        if(discovered.count(root) != 0)
-            return;
-        
-        discovered.insert(root);
-        nodes_of_root.insert(root);
-
-        findNodesDFS(low(root), nodes_of_root, discovered);
-        findNodesDFS(high(root), nodes_of_root, discovered);
+        std::vector<BDD_ID> found = findNodes(root);
+        nodes_of_root.insert(found.begin(), found.end());
     }
 
     /**
      * @brief returns the set of all variables that are reachable from root node
      * including itself
      *
-     *
-     * uses DFS algorithm
+     * Wrapper of the vector based findVars
      *
      * @param root
      * @param vars_of_root
      * @author Kamel Fakih
      */
     void Manager::findVars(const BDD_ID &root, std::set<BDD_ID> &vars_of_root){
-        std::unordered_set<BDD_ID> discovered = std::unordered_set<BDD_ID>();
-        findVarsDFS(root, vars_of_root, discovered);
+        std::vector<BDD_ID> found = findVars(root);
+        vars_of_root.insert(found.begin(), found.end());
+    }
+
+    /**
+     * @brief returns the edges reachable from root, including itself, in ascending order
+     *
+     * @param root
+     * @return std::vector<BDD_ID>
+     * @author Victor Herbert
+     */
+    std::vector<BDD_ID> Manager::findNodes(BDD_ID root){
+        std::vector<BDD_ID> found;
+        visitNodes(root, [&found](BDD_ID f){ found.push_back(f); });
+        std::sort(found.begin(), found.end());
+        return found;
     }
 
-    void Manager::findVarsDFS(const BDD_ID &root, std::set<BDD_ID> &vars_of_root, std::unordered_set<BDD_ID> &discovered){
+    /**
+     * @brief returns the variables root depends on, in ascending order
+     *
+     * @param root
+     * @return std::vector<BDD_ID>
+     * @author Victor Herbert
+     */
+    std::vector<BDD_ID> Manager::findVars(BDD_ID root){
+        std::vector<BDD_ID> found;
+        visitVars(root, [&found](BDD_ID x){ found.push_back(x); });
+        std::sort(found.begin(), found.end());
+        return found;
+    }
 
-        if((discovered.count(root) != 0) || isConstant(root)){
-            return;
+    /**
+     * @brief Calls visitor once for every edge reachable from root, parents before children
+     *
+     * An edge and its complement are distinct, as in findNodes. The traversal uses an
+     * explicit stack and the visited stamps of the manager, so the visitor must neither
+     * create nodes nor start another traversal.
+     *
+     * @param root
+     * @param visitor called with every reachable edge, root and constants included
+     * @author Victor Herbert
+     */
+    void Manager::visitNodes(BDD_ID root, const std::function<void(BDD_ID)> &visitor){
+        startVisit();
+        std::vector<BDD_ID> stack = {root};
+        while(!stack.empty()){
+            BDD_ID f = stack.back();
+            stack.pop_back();
+            if(!firstVisit(2 * nodeIndex(f) + (f & COMPLEMENT_BIT ? 1 : 0)))
+                continue;
+
+            visitor(f);
+            if(!isConstant(f)){
+                stack.push_back(high(f));
+                stack.push_back(low(f));
+            }
+        }
+    }
+
+    /**
+     * @brief Calls visitor once for every variable root depends on
+     *
+     * Only the regular nodes are traversed, so the second stamp of a node is free to
+     * mark its variable as reported. The same restrictions as for visitNodes apply.
+     *
+     * @param root
+     * @param visitor called with every variable in the support of root
+     * @author Victor Herbert
+     */
+    void Manager::visitVars(BDD_ID root, const std::function<void(BDD_ID)> &visitor){
+        startVisit();
+        std::vector<BDD_ID> stack = {nodeIndex(root)};
+        while(!stack.empty()){
+            BDD_ID node = stack.back();
+            stack.pop_back();
+            if(isConstant(node) || !firstVisit(2 * node))
+                continue;
+
+            BDD_ID x = topVar(node);
+            if(firstVisit(2 * x + 1))
+                visitor(x);
+            stack.push_back(nodeIndex(high(node)));
+            stack.push_back(nodeIndex(low(node)));
+        }
+    }
+
+    /**
+     * @brief Starts a traversal by moving on to a fresh epoch of the visited stamps
+     *
+     * Every node owns two stamps, one per polarity. Stamps of older epochs count as not
+     * visited, so the stamps are only cleared when the epoch counter wraps around.
+     *
+     * @author Victor Herbert
+     */
+    void Manager::startVisit(){
+        if(visit_stamps.size() < 2 * nodes.size())
+            visit_stamps.resize(2 * nodes.size(), 0);
+
+        if(++visit_epoch == 0){
+            std::fill(visit_stamps.begin(), visit_stamps.end(), 0);
+            visit_epoch = 1;
+        }
+    }
+
+    /**
+     * @brief Stamps a slot in the current epoch
+     *
+     * @return bool stating if the slot had not been stamped yet
+     * @author Victor Herbert
+     */
+    bool Manager::firstVisit(size_t slot){
+        if(visit_stamps[slot] == visit_epoch)
+            return false;
+        visit_stamps[slot] = visit_epoch;
+        return true;
+    }
+
+    BDDHandle::BDDHandle() : manager(nullptr), id(0){}
+
+    /**
+     * @brief Roots id in manager until the handle is destroyed or reassigned
+     *
+     * @param manager owning the BDD
+     * @param id BDD to be kept alive
+     * @author Victor Herbert
+     */
+    BDDHandle::BDDHandle(Manager &manager, BDD_ID id) : manager(&manager), id(id){
+        manager.ref(id);
+    }
+
+    BDDHandle::BDDHandle(const BDDHandle &other) : manager(other.manager), id(other.id){
+        if(manager)
+            manager->ref(id);
+    }
+
+    BDDHandle::BDDHandle(BDDHandle &&other) noexcept : manager(other.manager), id(other.id){
+        other.manager = nullptr;
+    }
+
+    BDDHandle::~BDDHandle(){
+        if(manager)
+            manager->deref(id);
+    }
+
+    BDDHandle &BDDHandle::operator=(BDDHandle other) noexcept{
+        std::swap(manager, other.manager);
+        std::swap(id, other.id);
+        return *this;
+    }
+
+    BDD_ID BDDHandle::get() const{
+        return id;
+    }
+
+    BDDHandle::operator BDD_ID() const{
+        return id;
+    }
+    /**
+     * @brief Starts enumerating the paths from f to the true node
+     *
+     * The cubes of the paths are disjoint and together cover exactly the satisfying
+     * assignments of f. They are produced one at a time, the high branch first.
+     * The BDD must not be reordered while the iterator is in use.
+     *
+     * @param manager owning the BDD
+     * @param f function whose cubes are enumerated
+     * @author Victor Herbert
+     */
+    CubeIterator::CubeIterator(Manager &manager, BDD_ID f) : manager(&manager), root(manager, f), finished(f == manager.False()){
+        if(!finished)
+            descend(f);
+    }
+
+    /**
+     * @brief Extends the current path to the leftmost path from f to the true node
+     *
+     * In a reduced BDD every node except the false node reaches the true node, so the
+     * descent never has to back up.
+     *
+     * @author Victor Herbert
+     */
+    void CubeIterator::descend(BDD_ID f){
+        while(!manager->isConstant(f)){
+            bool positive = manager->high(f) != manager->False();
+            BDD_ID var = manager->topVar(f);
+            path.push_back({f, positive});
+            cube.push_back(positive ? var : manager->neg(var));
+            f = positive ? manager->high(f) : manager->low(f);
         }
+    }
+
+    bool CubeIterator::done() const{
+        return finished;
+    }
 
-        vars_of_root.insert(topVar(root));
-        discovered.insert(root);
+    const std::vector<BDD_ID> &CubeIterator::operator*() const{
+        return cube;
+    }
 
-        findVarsDFS(low(root), vars_of_root, discovered);
-        findVarsDFS(high(root), vars_of_root, discovered);
+    /**
+     * @brief Moves on to the next cube, backing up to the deepest node whose low branch is unexplored
+     *
+     * @author Victor Herbert
+     */
+    CubeIterator &CubeIterator::operator++(){
+        while(!path.empty()){
+            auto [node, positive] = path.back();
+            path.pop_back();
+            cube.pop_back();
+
+            if(positive && manager->low(node) != manager->False()){
+                path.push_back({node, false});
+                cube.push_back(manager->neg(manager->topVar(node)));
+                descend(manager->low(node));
+                return *this;
+            }
+        }
+        finished = true;
+        return *this;
     }
-}
\ No newline at end of file
+}
@@ -6,61 +6,206 @@
 #define VDSPROJECT_MANAGER_H
 
 #include "ManagerInterface.h"
+#include "Node.h"
+#include "UniqueTable.h"
+#include "ComputedTable.h"
+#include "BigUnsigned.h"
 #include <vector>
 #include <unordered_map>
+#include <map>
 #include <iostream>
 #include <unordered_set>
 #include <functional>
+#include <initializer_list>
 //#include "gtest/gtest.h"
 // #include "Tests.h"
 
 
 namespace ClassProject {
 
-    struct Node{
-        BDD_ID low, high, topVar;
-
-        bool operator == (const Node &other) const {
-            return 
-                (low == other.low) &&
-                (high == other.high) &&
-                (topVar == other.topVar);
-        }
-
-        friend std::ostream& operator <<(std::ostream& stream, const Node& node);
-    };
-
-    template<size_t TABLE_SIZE>
-    struct NodeHashFunction{
-        std::size_t operator()(const Node& node) const{
-            return ((node.low<<16) + (node.high<<32) + (node.topVar<<0)) % TABLE_SIZE;
-        }
-    };
-
     //template<size_t UNIQUE_TABLE_SIZE = 1e6+3>
     class Manager : ManagerInterface{
-        const static size_t UNIQUE_TABLE_CAPACITY = 1e6+3;
-
-        std::vector<Node> nodes;
-        std::unordered_map<Node, BDD_ID, NodeHashFunction<UNIQUE_TABLE_CAPACITY>> unique_table; //TODO use hash table
-        std::unordered_map<Node, BDD_ID, NodeHashFunction<UNIQUE_TABLE_CAPACITY>> computed_table; //TODO use hash table
+        std::vector<StoredNode> nodes;
+        UniqueTable unique_table;
+        ComputedTable computed_table;
 
         std::unordered_map<int, std::string> labels;
 
+        std::vector<BDD_ID> free_slots;
+        std::unordered_map<BDD_ID, size_t> root_refs;
+        std::vector<BDD_ID> level_to_var;
+
+        /**
+         * @brief Pending call of the iterative apply engine
+         *
+         * @author Victor Herbert
+         */
+        struct ApplyFrame{
+            BDD_ID f, g, h;
+            BDD_ID top;
+            Level level;
+            bool negate;
+            bool high_done = false;
+            BDD_ID high = 0;
+        };
+
+        std::vector<ApplyFrame> apply_stack;
+
+        /**
+         * @brief Pending call of the iterative quantification
+         *
+         * @author Victor Herbert
+         */
+        struct QuantifyFrame{
+            BDD_ID f, g, cube;
+            BDD_ID top;
+            Level level;
+            bool quantified;
+            bool high_done = false;
+            BDD_ID high = 0;
+        };
+
+        std::vector<QuantifyFrame> quantify_stack;
+
+        size_t gc_threshold = 0;
+        size_t gc_next = 0;
+        size_t operation_depth = 0;
+
+        size_t reorder_threshold = 0;
+        size_t reorder_next = 0;
+        double reorder_max_growth = 1.2;
+        double reorder_time_limit = 0;
+
         const static BDD_ID FALSE_ADDRESS;
         const static BDD_ID TRUE_ADDRESS;
+        const static BDD_ID COMPLEMENT_BIT;
 
         const static Node FALSE_NODE;
         const static Node TRUE_NODE;
+        const static Level CONSTANT_LEVEL;
+
+        /**
+         * @brief Marks the lifetime of a public operation
+         *
+         * Only the outermost operation is a safe point for the automatic garbage
+         * collection and reordering, its operands are kept alive even if they are not rooted.
+         *
+         * @author Victor Herbert
+         */
+        class OperationScope{
+            Manager &manager;
+        public:
+            OperationScope(Manager &manager, std::initializer_list<BDD_ID> operands);
+            ~OperationScope();
+        };
 
         BDD_ID addNode(Node data);
-        void bfs(const BDD_ID root, std::vector<BDD_ID> &order, std::vector<bool> &marc);
 
-        void findNodesDFS(const BDD_ID &root, std::set<BDD_ID> &nodes_of_root, std::unordered_set<BDD_ID> &discovered);
-        void findVarsDFS(const BDD_ID &root, std::set<BDD_ID> &vars_of_root, std::unordered_set<BDD_ID> &discovered);
+        BDD_ID newNode(Node node, Level level, NodeIndex &slot);
+
+        BDD_ID storeNode(Node node, Level level, NodeIndex &slot);
+
+        Level level(BDD_ID f);
+
+        bool isFree(BDD_ID f);
+
+        size_t markAndSweep(std::initializer_list<BDD_ID> operands);
+
+        /**
+         * @brief Bookkeeping of a reordering run
+         *
+         * Reference counts of all nodes and the nodes found on every level, both kept
+         * up to date by the level swaps. The level lists may hold stale ids, which are
+         * filtered out when a level is swapped.
+         *
+         * @author Victor Herbert
+         */
+        struct ReorderState{
+            std::vector<size_t> refs;
+            std::vector<std::vector<BDD_ID>> level_nodes;
+        };
+
+        void startReorder(ReorderState &state, std::initializer_list<BDD_ID> operands);
+
+        size_t sift(std::initializer_list<BDD_ID> operands);
+
+        void siftVariable(ReorderState &state, BDD_ID var);
+
+        void swapLevels(ReorderState &state, size_t level);
+
+        std::vector<BDD_ID> takeLevel(ReorderState &state, size_t level);
+
+        BDD_ID reorderNode(ReorderState &state, Node node, Level level);
+
+        void releaseNode(ReorderState &state, BDD_ID f);
+
+        static bool isComplement(BDD_ID f);
+        static BDD_ID complement(BDD_ID f);
+        static BDD_ID nodeIndex(BDD_ID f);
+        bool precedes(BDD_ID f, BDD_ID g);
+
+        BDD_ID apply(ComputedTable::Operation op, BDD_ID f, BDD_ID g, BDD_ID h);
+
+        bool standardize(ComputedTable::Operation op, BDD_ID &f, BDD_ID &g, BDD_ID &h, bool &negate, BDD_ID &result);
+
+        bool standardTriple(BDD_ID &i, BDD_ID &t, BDD_ID &e, bool &negate, BDD_ID &result);
+
+        bool standardAnd(BDD_ID &f, BDD_ID &g, BDD_ID &result);
+
+        bool standardXor(BDD_ID &f, BDD_ID &g, bool &negate, BDD_ID &result);
+
+        bool standardRestrict(BDD_ID &f, BDD_ID &cube, bool &negate, BDD_ID &result);
+
+        std::vector<BDD_ID> postOrder(BDD_ID f);
+
+        std::vector<BDD_ID> postOrder(const std::vector<BDD_ID> &roots);
+
+        BDD_ID applyN(ComputedTable::Operation op, const std::vector<BDD_ID> &operands);
+
+        bool standardAndExists(BDD_ID &f, BDD_ID &g, BDD_ID &cube, BDD_ID &result);
+
+        BDD_ID cubeRest(BDD_ID cube);
+
+        BDD_ID topCofactor(BDD_ID f, Level top, bool positive);
+
+        std::vector<uint32_t> visit_stamps;
+        uint32_t visit_epoch = 0;
+
+        void startVisit();
+
+        bool firstVisit(size_t slot);
 
     public:
 
+        /**
+         * @brief Operation counters of the manager, together with the statistics of its tables
+         *
+         * The counters are maintained when the library is built with COLLECT_STATS (the
+         * default) and stay zero otherwise. Operations that share a kernel are counted
+         * together, or2, nand2 and nor2 count as and2 and xnor2 as xor2.
+         *
+         * @author Victor Herbert
+         */
+        struct Stats{
+            size_t ite;
+            size_t and2;
+            size_t xor2;
+            size_t coFactor;
+            size_t restrict;
+            size_t andExists;
+            size_t compose;
+            size_t naryOperations;
+
+            size_t recursiveCalls;   ///< calls of the apply and quantification engines, nested ones included
+            size_t terminalCases;    ///< calls answered without the computed table
+            size_t standardTriples;  ///< ite triples rewritten into their standard form
+            size_t maxDepth;         ///< deepest work stack of the engines
+            size_t peakNodes;        ///< most nodes alive at the same time
+
+            UniqueTable::Stats uniqueTable;
+            ComputedTable::Stats computedTable;
+        };
+
         Manager();
         Manager(std::vector<Node> nodes);
 
@@ -76,6 +221,8 @@ namespace ClassProject {
 
         bool isExpression(BDD_ID x);
 
+        bool isValid(BDD_ID f);
+
         BDD_ID topVar(BDD_ID f);
 
         BDD_ID topVar(BDD_ID f, BDD_ID g);
@@ -96,6 +243,37 @@ namespace ClassProject {
 
         BDD_ID coFactorFalse(BDD_ID f);
 
+        bool isCube(BDD_ID f);
+
+        BDD_ID makeCube(const std::vector<BDD_ID> &literals);
+
+        BDD_ID restrict(BDD_ID f, BDD_ID cube);
+
+        BDD_ID exists(BDD_ID f, BDD_ID cube);
+
+        BDD_ID forall(BDD_ID f, BDD_ID cube);
+
+        BDD_ID andExists(BDD_ID f, BDD_ID g, BDD_ID cube);
+
+        BDD_ID compose(BDD_ID f, const std::unordered_map<BDD_ID, BDD_ID> &substitution);
+
+        size_t nodeCount(BDD_ID f);
+
+        size_t nodeCount(BDD_ID f, size_t limit);
+
+        double satCount(BDD_ID f, size_t nVars);
+
+        double satCountLog2(BDD_ID f, size_t nVars);
+
+        BigUnsigned satCountExact(BDD_ID f, size_t nVars);
+
+        bool pickOneCube(BDD_ID f, std::vector<BDD_ID> &cube);
+
+        std::vector<uint64_t> evaluateBatch(BDD_ID root, const std::vector<std::vector<uint64_t>> &assignments);
+
+        std::vector<std::vector<uint64_t>> evaluateBatch(const std::vector<BDD_ID> &roots,
+                                                         const std::vector<std::vector<uint64_t>> &assignments);
+
         void updateNodeLabel(BDD_ID id, BDD_ID a, BDD_ID b, std::string op);
 
         BDD_ID and2(BDD_ID a, BDD_ID b);
@@ -112,15 +290,120 @@ namespace ClassProject {
 
         BDD_ID xnor2(BDD_ID a, BDD_ID b);
 
+        BDD_ID andN(const std::vector<BDD_ID> &operands);
+
+        BDD_ID orN(const std::vector<BDD_ID> &operands);
+
+        BDD_ID xorN(const std::vector<BDD_ID> &operands);
+
         std::string getTopVarName(const BDD_ID &root);
 
         void findNodes(const BDD_ID &root, std::set<BDD_ID> &nodes_of_root);
 
         void findVars(const BDD_ID &root, std::set<BDD_ID> &vars_of_root);
 
+        std::vector<BDD_ID> findNodes(BDD_ID root);
+
+        std::vector<BDD_ID> findVars(BDD_ID root);
+
+        void visitNodes(BDD_ID root, const std::function<void(BDD_ID)> &visitor);
+
+        void visitVars(BDD_ID root, const std::function<void(BDD_ID)> &visitor);
+
         size_t uniqueTableSize();
 
+        UniqueTable::Stats uniqueTableStats();
+
+        void setComputedTableSize(size_t size, size_t max_size);
+
+        ComputedTable::Stats computedTableStats();
+
+        Stats stats();
+
+        void resetStats();
+
+        void ref(BDD_ID f);
+
+        void deref(BDD_ID f);
+
+        size_t collectGarbage();
+
+        void setGarbageCollectionThreshold(size_t threshold);
+
         void visualizeBDD(std::string filepath, BDD_ID &root);
+
+        void save(const std::string &filepath, const std::map<std::string, BDD_ID> &roots = {});
+
+        std::map<std::string, BDD_ID> load(const std::string &filepath);
+
+        size_t getLevel(BDD_ID x);
+
+        BDD_ID varAtLevel(size_t level);
+
+        std::vector<BDD_ID> getVariableOrder();
+
+        void setVariableOrder(const std::vector<BDD_ID> &order);
+
+        size_t reorder();
+
+        void setReorderThreshold(size_t threshold);
+
+        void setReorderLimits(double max_growth, double max_seconds_per_var);
+
+    private:
+        Stats counters = {};
+    };
+
+    /**
+     * @brief Keeps a BDD alive across garbage collections
+     *
+     * The handle registers its id as an external root of the manager for as long as it
+     * exists. It converts to BDD_ID, so it can be passed to any Manager operation.
+     *
+     * @author Victor Herbert
+     */
+    class BDDHandle{
+        Manager *manager;
+        BDD_ID id;
+
+    public:
+        BDDHandle();
+        BDDHandle(Manager &manager, BDD_ID id);
+        BDDHandle(const BDDHandle &other);
+        BDDHandle(BDDHandle &&other) noexcept;
+        ~BDDHandle();
+
+        BDDHandle &operator=(BDDHandle other) noexcept;
+
+        BDD_ID get() const;
+
+        operator BDD_ID() const;
+    };
+
+    /**
+     * @brief Lazily enumerates the cubes of the paths from a BDD to the true node
+     *
+     * Only the current path is stored, so the cubes of huge BDDs can be streamed.
+     *
+     * @author Victor Herbert
+     */
+    class CubeIterator{
+        Manager *manager;
+        BDDHandle root;
+        std::vector<std::pair<BDD_ID, bool>> path;
+        std::vector<BDD_ID> cube;
+        bool finished;
+
+        void descend(BDD_ID f);
+
+    public:
+        CubeIterator(Manager &manager, BDD_ID f);
+
+        bool done() const;
+
+        const std::vector<BDD_ID> &operator*() const;
+
+        CubeIterator &operator++();
     };
 
 }
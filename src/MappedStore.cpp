@@ -0,0 +1,338 @@
+#include "MappedStore.h"
+#include "Snapshot.h"
+#include <stdexcept>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace ClassProject {
+
+    const BDD_ID MappedStore::COMPLEMENT_BIT = BDD_ID(1) << 31;
+
+    namespace {
+
+        /**
+         * @brief Bounds checked reader for the sections behind the node table
+         *
+         * @author Victor Herbert
+         */
+        class Cursor {
+        public:
+            Cursor(const char *data, size_t length, size_t offset) : data(data), length(length), offset(offset){}
+
+            template<typename T>
+            T value(){
+                T value;
+                std::memcpy(&value, take(sizeof(T)), sizeof(T));
+                return value;
+            }
+
+            std::string string(){
+                size_t size = value<uint32_t>();
+                return std::string(take(size), size);
+            }
+
+            const char *take(size_t size){
+                if(size > length - offset)
+                    throw std::runtime_error("truncated snapshot");
+                const char *position = data + offset;
+                offset += size;
+                return position;
+            }
+
+        private:
+            const char *data;
+            size_t length;
+            size_t offset;
+        };
+
+    }
+
+    /**
+     * @brief Maps a snapshot file and reads its labels and roots
+     *
+     * @param filepath of a snapshot written by Manager::save
+     * @author Victor Herbert
+     */
+    MappedStore::MappedStore(const std::string &filepath) : data(nullptr), length(0), node_count(0), var_count(0){
+        int fd = open(filepath.c_str(), O_RDONLY);
+        if(fd < 0)
+            throw std::runtime_error("unable to open snapshot file " + filepath);
+
+        struct stat status;
+        if(fstat(fd, &status) != 0 || status.st_size < (off_t) Snapshot::TABLE_OFFSET){
+            close(fd);
+            throw std::runtime_error("not a BDD snapshot");
+        }
+
+        // the mapping stays valid after closing the descriptor
+        length = status.st_size;
+        void *mapping = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if(mapping == MAP_FAILED)
+            throw std::runtime_error("unable to map snapshot file " + filepath);
+        data = static_cast<const char *>(mapping);
+
+        try{
+            Cursor header(data, length, 0);
+            const char *magic = header.take(sizeof(Snapshot::MAGIC));
+            if(!std::equal(magic, magic + sizeof(Snapshot::MAGIC), Snapshot::MAGIC))
+                throw std::runtime_error("not a BDD snapshot");
+            if(header.value<uint32_t>() != Snapshot::VERSION)
+                throw std::runtime_error("unsupported snapshot version");
+
+            uint64_t nodes = header.value<uint64_t>();
+            uint64_t vars = header.value<uint64_t>();
+            if(nodes < 2 || nodes > (length - Snapshot::TABLE_OFFSET) / Snapshot::NODE_SIZE)
+                throw std::runtime_error("truncated snapshot");
+            node_count = nodes;
+
+            // only the sections behind the table and the variable order are parsed
+            Cursor tail(data, length, Snapshot::TABLE_OFFSET + node_count * Snapshot::NODE_SIZE);
+            tail.take(std::min<uint64_t>(vars, length) * sizeof(uint64_t));
+            var_count = vars;
+
+            for(uint64_t i = tail.value<uint64_t>(); i > 0; i--){
+                int id = tail.value<int64_t>();
+                labels[id] = tail.string();
+            }
+
+            for(uint64_t i = tail.value<uint64_t>(); i > 0; i--){
+                std::string name = tail.string();
+                BDD_ID id = tail.value<uint64_t>();
+                BDD_ID index = id & ~COMPLEMENT_BIT;
+                if(index >= node_count || field(index, 2) == Snapshot::FREE)
+                    throw std::runtime_error("corrupt snapshot: unknown root " + name);
+                named_roots[name] = id;
+            }
+        }
+        catch(...){
+            unmap();
+            throw;
+        }
+    }
+
+    MappedStore::MappedStore(MappedStore &&other) noexcept
+        : data(other.data), length(other.length), node_count(other.node_count), var_count(other.var_count),
+          labels(std::move(other.labels)), named_roots(std::move(other.named_roots)){
+        other.data = nullptr;
+        other.length = 0;
+        other.node_count = 0;
+        other.var_count = 0;
+    }
+
+    MappedStore &MappedStore::operator=(MappedStore &&other) noexcept{
+        if(this != &other){
+            unmap();
+            data = other.data;
+            length = other.length;
+            node_count = other.node_count;
+            var_count = other.var_count;
+            labels = std::move(other.labels);
+            named_roots = std::move(other.named_roots);
+            other.data = nullptr;
+            other.length = 0;
+            other.node_count = 0;
+            other.var_count = 0;
+        }
+        return *this;
+    }
+
+    MappedStore::~MappedStore(){
+        unmap();
+    }
+
+    void MappedStore::unmap(){
+        if(data != nullptr)
+            munmap(const_cast<char *>(data), length);
+        data = nullptr;
+    }
+
+    /**
+     * @brief Reads one of the three fields (low, high, topVar) of the node of an edge
+     *
+     * The table starts at an offset that is not a multiple of 8, so the values are
+     * copied out instead of being dereferenced in place.
+     *
+     * The index is checked against the table, so an edge read from a corrupt file, or a
+     * free slot, throws instead of reading outside the mapping.
+     *
+     * @param f edge to the node
+     * @param offset 0 for low, 1 for high, 2 for topVar
+     * @return uint64_t stored value
+     * @author Victor Herbert
+     */
+    uint64_t MappedStore::field(BDD_ID f, size_t offset) const{
+        BDD_ID index = f & ~COMPLEMENT_BIT;
+        if(index >= node_count)
+            throw std::out_of_range("unknown node " + std::to_string(f));
+
+        uint64_t value;
+        std::memcpy(&value, data + Snapshot::TABLE_OFFSET + index * Snapshot::NODE_SIZE
+                            + offset * sizeof(uint64_t), sizeof(value));
+        return value;
+    }
+
+    /**
+     * @brief Slot of an edge in a visited bitmap, an edge and its complement are distinct
+     *
+     * @author Victor Herbert
+     */
+    size_t MappedStore::visitSlot(BDD_ID f){
+        return 2 * (f & ~COMPLEMENT_BIT) + (f & COMPLEMENT_BIT ? 1 : 0);
+    }
+
+    BDD_ID MappedStore::complement(BDD_ID f){
+        return f <= 1 ? f ^ 1 : f ^ COMPLEMENT_BIT;
+    }
+
+    BDD_ID MappedStore::True() const{
+        return 1;
+    }
+
+    BDD_ID MappedStore::False() const{
+        return 0;
+    }
+
+    bool MappedStore::isConstant(BDD_ID f) const{
+        return f == True() || f == False();
+    }
+
+    bool MappedStore::isVariable(BDD_ID x) const{
+        return !(x & COMPLEMENT_BIT) && x < node_count && !isConstant(x) && field(x, 2) == x;
+    }
+
+    BDD_ID MappedStore::topVar(BDD_ID f) const{
+        return field(f, 2);
+    }
+
+    /**
+     * @brief returns the high successor of f, complemented along with f
+     *
+     * @param f edge to the node
+     * @return BDD_ID
+     * @author Victor Herbert
+     */
+    BDD_ID MappedStore::high(BDD_ID f) const{
+        BDD_ID high = field(f, 1);
+        return (f & COMPLEMENT_BIT) ? complement(high) : high;
+    }
+
+    /**
+     * @brief returns the low successor of f, complemented along with f
+     *
+     * @param f edge to the node
+     * @return BDD_ID
+     * @author Victor Herbert
+     */
+    BDD_ID MappedStore::low(BDD_ID f) const{
+        BDD_ID low = field(f, 0);
+        return (f & COMPLEMENT_BIT) ? complement(low) : low;
+    }
+
+    std::string MappedStore::getTopVarName(const BDD_ID &root) const{
+        auto label = labels.find(topVar(root));
+        return label == labels.end() ? std::string() : label->second;
+    }
+
+    /**
+     * @brief returns the set of all edges reachable from root, including itself,
+     * with the same ids Manager::findNodes reports
+     *
+     * @param root
+     * @param nodes_of_root
+     * @author Victor Herbert
+     */
+    void MappedStore::findNodes(const BDD_ID &root, std::set<BDD_ID> &nodes_of_root) const{
+        std::vector<bool> discovered(2 * node_count, false);
+        std::vector<BDD_ID> stack = {root};
+        while(!stack.empty()){
+            BDD_ID f = stack.back();
+            stack.pop_back();
+            // reading the children first throws for an edge outside the table
+            BDD_ID f_high = high(f), f_low = low(f);
+            if(discovered[visitSlot(f)])
+                continue;
+
+            discovered[visitSlot(f)] = true;
+            nodes_of_root.insert(f);
+            stack.push_back(f_high);
+            stack.push_back(f_low);
+        }
+    }
+
+    /**
+     * @brief returns the set of all variables root depends on
+     *
+     * @param root
+     * @param vars_of_root
+     * @author Victor Herbert
+     */
+    void MappedStore::findVars(const BDD_ID &root, std::set<BDD_ID> &vars_of_root) const{
+        std::vector<bool> discovered(2 * node_count, false);
+        std::vector<BDD_ID> stack = {root};
+        while(!stack.empty()){
+            BDD_ID f = stack.back();
+            stack.pop_back();
+            if(isConstant(f))
+                continue;
+
+            // reading the node first throws for an edge outside the table
+            BDD_ID x = topVar(f);
+            if(discovered[visitSlot(f)])
+                continue;
+
+            discovered[visitSlot(f)] = true;
+            vars_of_root.insert(x);
+            stack.push_back(high(f));
+            stack.push_back(low(f));
+        }
+    }
+
+    /**
+     * @brief Evaluates f under an assignment by following a single path
+     *
+     * A path passes every variable at most once, so a walk that takes more steps than
+     * there are variables runs in a cycle of a corrupt table and throws.
+     *
+     * @param f function to be evaluated
+     * @param values value of every variable, indexed by the id of the variable
+     * @return bool value of f
+     * @author Victor Herbert
+     */
+    bool MappedStore::evaluate(BDD_ID f, const std::vector<bool> &values) const{
+        for(size_t steps = 0; !isConstant(f); steps++){
+            if(steps == var_count)
+                throw std::runtime_error("corrupt snapshot, the path of " + std::to_string(f) + " does not end");
+            BDD_ID x = topVar(f);
+            if(x >= values.size())
+                throw std::out_of_range("no value for variable " + std::to_string(x));
+            f = values[x] ? high(f) : low(f);
+        }
+        return f == True();
+    }
+
+    /**
+     * @brief returns the number of node slots of the snapshot, free slots included
+     *
+     * @return size_t
+     * @author Victor Herbert
+     */
+    size_t MappedStore::size() const{
+        return node_count;
+    }
+
+    /**
+     * @brief returns the roots stored in the snapshot, by name
+     *
+     * @return const std::map<std::string, BDD_ID>&
+     * @author Victor Herbert
+     */
+    const std::map<std::string, BDD_ID> &MappedStore::roots() const{
+        return named_roots;
+    }
+
+}
@@ -0,0 +1,94 @@
+// A minimalistic BDD library, following Wolfgang Kunz lecture slides
+//
+// Created by Markus Wedler 2014
+
+#ifndef VDSPROJECT_MAPPEDSTORE_H
+#define VDSPROJECT_MAPPEDSTORE_H
+
+#include "ManagerInterface.h"
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace ClassProject {
+
+    /**
+     * @brief Read-only view of a snapshot written by Manager::save
+     *
+     * The file is mapped into memory and the node table is read in place, so opening a
+     * store only parses the labels and roots behind the table, no matter how many nodes
+     * it holds. Pages are loaded on first access and, being mapped shared and read-only,
+     * are served from the same page cache to every process that opens the file. The ids
+     * and complement edges are the ones of the manager that saved the snapshot.
+     *
+     * Only the header, the labels and the roots are checked on opening. The node table is
+     * checked as it is read, an edge outside of it throws std::out_of_range.
+     *
+     * @author Victor Herbert
+     */
+    class MappedStore {
+    public:
+        explicit MappedStore(const std::string &filepath);
+
+        MappedStore(MappedStore &&other) noexcept;
+
+        MappedStore &operator=(MappedStore &&other) noexcept;
+
+        MappedStore(const MappedStore &) = delete;
+
+        MappedStore &operator=(const MappedStore &) = delete;
+
+        ~MappedStore();
+
+        BDD_ID True() const;
+
+        BDD_ID False() const;
+
+        bool isConstant(BDD_ID f) const;
+
+        bool isVariable(BDD_ID x) const;
+
+        BDD_ID topVar(BDD_ID f) const;
+
+        BDD_ID high(BDD_ID f) const;
+
+        BDD_ID low(BDD_ID f) const;
+
+        std::string getTopVarName(const BDD_ID &root) const;
+
+        void findNodes(const BDD_ID &root, std::set<BDD_ID> &nodes_of_root) const;
+
+        void findVars(const BDD_ID &root, std::set<BDD_ID> &vars_of_root) const;
+
+        bool evaluate(BDD_ID f, const std::vector<bool> &values) const;
+
+        size_t size() const;
+
+        const std::map<std::string, BDD_ID> &roots() const;
+
+    private:
+        const static BDD_ID COMPLEMENT_BIT;
+
+        const char *data;
+        size_t length;
+        size_t node_count;
+        size_t var_count;
+
+        std::unordered_map<int, std::string> labels;
+        std::map<std::string, BDD_ID> named_roots;
+
+        uint64_t field(BDD_ID f, size_t offset) const;
+
+        static BDD_ID complement(BDD_ID f);
+
+        static size_t visitSlot(BDD_ID f);
+
+        void unmap();
+    };
+
+}
+
+#endif
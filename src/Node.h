@@ -0,0 +1,74 @@
+// A minimalistic BDD library, following Wolfgang Kunz lecture slides
+//
+// Created by Markus Wedler 2014
+
+#ifndef VDSPROJECT_NODE_H
+#define VDSPROJECT_NODE_H
+
+#include "ManagerInterface.h"
+#include <iostream>
+#include <cstdint>
+
+namespace ClassProject {
+
+    struct Node{
+        BDD_ID low, high, topVar;
+
+        bool operator == (const Node &other) const {
+            return
+                (low == other.low) &&
+                (high == other.high) &&
+                (topVar == other.topVar);
+        }
+
+        friend std::ostream& operator <<(std::ostream& stream, const Node& node);
+    };
+
+    // ids stay below the complement bit 2^31 in both layouts, so 32 bit edges suffice
+    typedef uint32_t NodeIndex;
+#ifdef COMPACT_NODES
+    typedef uint16_t Level;
+#else
+    typedef uint32_t Level;
+#endif
+
+    /**
+     * @brief Layout of a node inside the manager
+     *
+     * Besides the edges, a stored node keeps the level of its top variable, so ordering
+     * decisions do not have to look up the variable node, and a few flag bits for the
+     * garbage collection. Edges are 32 bit, which limits the manager to 2^31 nodes, and a
+     * node takes 20 bytes. Built with COMPACT_NODES, the level is 16 bit and the node takes
+     * 16 bytes, which also limits the manager to 2^16 - 1 variables.
+     *
+     * @author Victor Herbert
+     */
+    struct StoredNode{
+        const static uint16_t FREE = 1;
+        const static uint16_t MARKED = 2;
+
+        NodeIndex low, high, topVar;
+        Level level;
+        uint16_t flags;
+
+        Node node() const {
+            return {.low = low, .high = high, .topVar = topVar};
+        }
+
+        bool operator == (const Node &other) const {
+            return
+                (low == other.low) &&
+                (high == other.high) &&
+                (topVar == other.topVar);
+        }
+    };
+
+#ifdef COMPACT_NODES
+    static_assert(sizeof(StoredNode) == 16, "compact nodes must fit into 16 bytes");
+#else
+    static_assert(sizeof(StoredNode) == 20, "nodes must fit into 20 bytes");
+#endif
+
+}
+
+#endif
@@ -0,0 +1,40 @@
+// A minimalistic BDD library, following Wolfgang Kunz lecture slides
+//
+// Created by Markus Wedler 2014
+
+#ifndef VDSPROJECT_SNAPSHOT_H
+#define VDSPROJECT_SNAPSHOT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+namespace ClassProject {
+
+    /**
+     * @brief Layout of the binary snapshots written by Manager::save
+     *
+     * The file starts with the magic number, the format version, the number of node
+     * slots and the number of variables. Then follows the node table, three 64 bit
+     * values (low, high, topVar) per slot with free slots set to FREE, so a node can be
+     * located without parsing. After the table come the variable order, the labels
+     * and the named roots.
+     *
+     * @author Victor Herbert
+     */
+    namespace Snapshot {
+
+        const char MAGIC[8] = {'V', 'D', 'S', 'B', 'D', 'D', '\0', '\0'};
+        const uint32_t VERSION = 1;
+        const uint64_t FREE = std::numeric_limits<uint64_t>::max();
+
+        const size_t NODE_COUNT_OFFSET = sizeof(MAGIC) + sizeof(VERSION);
+        const size_t VAR_COUNT_OFFSET = NODE_COUNT_OFFSET + sizeof(uint64_t);
+        const size_t TABLE_OFFSET = VAR_COUNT_OFFSET + sizeof(uint64_t);
+        const size_t NODE_SIZE = 3 * sizeof(uint64_t);
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,204 @@
+#include "UniqueTable.h"
+#include <limits>
+
+namespace ClassProject {
+
+    const NodeIndex UniqueTable::EMPTY = std::numeric_limits<NodeIndex>::max();
+    const size_t UniqueTable::DEFAULT_CAPACITY = 1 << 12;
+    const double UniqueTable::MAX_LOAD_FACTOR = 0.7;
+
+    /**
+     * @brief Construct an empty unique table
+     *
+     * @param capacity initial number of slots, rounded up to a power of two
+     * @author Victor Herbert
+     */
+    UniqueTable::UniqueTable(size_t capacity) : count(0), lookups(0), probes(0), max_probe_length(0){
+        size_t slots_size = 1;
+        while(slots_size < capacity)
+            slots_size <<= 1;
+
+        slots.assign(slots_size, EMPTY);
+        mask = slots_size - 1;
+    }
+
+    /**
+     * @brief Mixes the three fields of a node into a 64 bit hash
+     *
+     * Every field goes through a multiply-xorshift round so that nodes which only
+     * differ in their low bits still land in different regions of the table
+     *
+     * @param node key to be hashed
+     * @return size_t hash value
+     * @author Victor Herbert
+     */
+    size_t UniqueTable::hash(const Node &node){
+        size_t h = node.topVar * 0x9E3779B97F4A7C15ULL;
+        h = (h ^ node.low) * 0xBF58476D1CE4E5B9ULL;
+        h = (h ^ node.high) * 0x94D049BB133111EBULL;
+        return h ^ (h >> 31);
+    }
+
+    /**
+     * @brief Finds the slot of a node, or the empty slot where it has to be inserted
+     *
+     * The caller checks the returned slot against EMPTY. When it is empty and the node
+     * is added, the caller writes the new id into the slot and calls inserted(), so a
+     * find-or-insert walks a single probe sequence.
+     *
+     * @param node key to be searched
+     * @param nodes node vector the ids stored in the table refer to
+     * @return NodeIndex& slot holding the id of the node or EMPTY
+     * @author Victor Herbert
+     */
+    NodeIndex &UniqueTable::lookup(const Node &node, const std::vector<StoredNode> &nodes){
+        size_t pos = hash(node) & mask;
+        size_t probe_length = 1;
+
+        while(slots[pos] != EMPTY && !(nodes[slots[pos]] == node)){
+            pos = (pos + 1) & mask;
+            probe_length++;
+        }
+
+        lookups++;
+        probes += probe_length;
+        if(probe_length > max_probe_length)
+            max_probe_length = probe_length;
+
+        return slots[pos];
+    }
+
+    /**
+     * @brief Registers that the slot returned by the last lookup was filled
+     *
+     * @param nodes node vector, needed to rehash the keys if the table grows
+     * @author Victor Herbert
+     */
+    void UniqueTable::inserted(const std::vector<StoredNode> &nodes){
+        count++;
+        if(count > MAX_LOAD_FACTOR * slots.size())
+            grow(nodes);
+    }
+
+    /**
+     * @brief Removes a stored id, keeping the probe sequences of the others intact
+     *
+     * Instead of leaving a tombstone, the following entries of the cluster are shifted
+     * back into the hole whenever that does not move them in front of their home slot.
+     * The node of the id and of every other stored id must still be readable in nodes.
+     *
+     * @param id stored id to be removed
+     * @param nodes node vector the stored ids refer to
+     * @author Victor Herbert
+     */
+    void UniqueTable::erase(BDD_ID id, const std::vector<StoredNode> &nodes){
+        size_t hole = hash(nodes[id].node()) & mask;
+        while(slots[hole] != id){
+            if(slots[hole] == EMPTY)
+                return;
+            hole = (hole + 1) & mask;
+        }
+
+        for(size_t pos = (hole + 1) & mask; slots[pos] != EMPTY; pos = (pos + 1) & mask){
+            size_t home = hash(nodes[slots[pos]].node()) & mask;
+            // the entry may fill the hole if its home does not lie cyclically in (hole, pos]
+            if(((pos - home) & mask) >= ((pos - hole) & mask)){
+                slots[hole] = slots[pos];
+                hole = pos;
+            }
+        }
+
+        slots[hole] = EMPTY;
+        count--;
+    }
+
+    /**
+     * @brief Replaces the contents by every node of a vector that is not free
+     *
+     * The nodes are known to be pairwise distinct, so each id is placed into the first
+     * empty slot of its probe sequence without comparing any keys, and the table is
+     * sized up front so it never grows on the way.
+     *
+     * @param nodes canonical node vector, such as one restored from a snapshot
+     * @author Victor Herbert
+     */
+    void UniqueTable::build(const std::vector<StoredNode> &nodes){
+        size_t slots_size = DEFAULT_CAPACITY;
+        while(nodes.size() > MAX_LOAD_FACTOR * slots_size)
+            slots_size <<= 1;
+
+        slots.assign(slots_size, EMPTY);
+        mask = slots_size - 1;
+        count = 0;
+        lookups = 0;
+        probes = 0;
+        max_probe_length = 0;
+
+        for(size_t id = 0; id < nodes.size(); id++){
+            if(nodes[id].flags & StoredNode::FREE)
+                continue;
+
+            size_t pos = hash(nodes[id].node()) & mask;
+            while(slots[pos] != EMPTY)
+                pos = (pos + 1) & mask;
+            slots[pos] = id;
+            count++;
+        }
+    }
+
+    /**
+     * @brief Doubles the number of slots and reinserts every stored id
+     *
+     * @param nodes node vector the stored ids refer to
+     * @author Victor Herbert
+     */
+    void UniqueTable::grow(const std::vector<StoredNode> &nodes){
+        std::vector<NodeIndex> old_slots = std::move(slots);
+        slots.assign(old_slots.size() * 2, EMPTY);
+        mask = slots.size() - 1;
+
+        for(NodeIndex id : old_slots){
+            if(id == EMPTY)
+                continue;
+
+            size_t pos = hash(nodes[id].node()) & mask;
+            while(slots[pos] != EMPTY)
+                pos = (pos + 1) & mask;
+            slots[pos] = id;
+        }
+    }
+
+    size_t UniqueTable::size() const{
+        return count;
+    }
+
+    size_t UniqueTable::capacity() const{
+        return slots.size();
+    }
+
+    double UniqueTable::loadFactor() const{
+        return (double) count / slots.size();
+    }
+
+    /**
+     * @brief returns a snapshot of the occupancy and probing statistics
+     *
+     * @return Stats
+     * @author Victor Herbert
+     */
+    UniqueTable::Stats UniqueTable::stats() const{
+        return {
+            .size = count,
+            .capacity = slots.size(),
+            .loadFactor = loadFactor(),
+            .lookups = lookups,
+            .probes = probes,
+            .maxProbeLength = max_probe_length
+        };
+    }
+
+    double UniqueTable::Stats::averageProbeLength() const{
+        return lookups == 0 ? 0 : (double) probes / lookups;
+    }
+
+}
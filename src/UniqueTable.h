@@ -0,0 +1,74 @@
+// A minimalistic BDD library, following Wolfgang Kunz lecture slides
+//
+// Created by Markus Wedler 2014
+
+#ifndef VDSPROJECT_UNIQUETABLE_H
+#define VDSPROJECT_UNIQUETABLE_H
+
+#include "Node.h"
+#include <vector>
+
+namespace ClassProject {
+
+    /**
+     * @brief Open addressing hash table from (topVar, low, high) to the id of the node
+     *
+     * Slots only hold node ids, the keys are read back from the node vector owned by
+     * the Manager, so an entry costs a single BDD_ID. Collisions are resolved by linear
+     * probing over a power of two sized slot array that doubles once the load factor
+     * exceeds MAX_LOAD_FACTOR.
+     *
+     * @author Victor Herbert
+     */
+    class UniqueTable {
+    public:
+        const static NodeIndex EMPTY;
+        const static size_t DEFAULT_CAPACITY;
+        const static double MAX_LOAD_FACTOR;
+
+        struct Stats{
+            size_t size;
+            size_t capacity;
+            double loadFactor;
+            size_t lookups;
+            size_t probes;
+            size_t maxProbeLength;
+
+            double averageProbeLength() const;
+        };
+
+        explicit UniqueTable(size_t capacity = DEFAULT_CAPACITY);
+
+        NodeIndex &lookup(const Node &node, const std::vector<StoredNode> &nodes);
+
+        void inserted(const std::vector<StoredNode> &nodes);
+
+        void erase(BDD_ID id, const std::vector<StoredNode> &nodes);
+
+        void build(const std::vector<StoredNode> &nodes);
+
+        size_t size() const;
+
+        size_t capacity() const;
+
+        double loadFactor() const;
+
+        Stats stats() const;
+
+        static size_t hash(const Node &node);
+
+    private:
+        std::vector<NodeIndex> slots;
+        size_t mask;
+        size_t count;
+
+        size_t lookups;
+        size_t probes;
+        size_t max_probe_length;
+
+        void grow(const std::vector<StoredNode> &nodes);
+    };
+
+}
+
+#endif
@@ -6,6 +6,8 @@
 #include "CircuitToBDD.hpp"
 
 #include <utility>
+#include <algorithm>
+#include <cmath>
 
 
 CircuitToBDD::CircuitToBDD(shared_ptr<ClassProject::Manager> BDD_manager_p) {
@@ -17,16 +19,7 @@ CircuitToBDD::~CircuitToBDD() = default;
 void CircuitToBDD::GenerateBDD(const list_of_circuit_t &circuit, const std::string& benchmark_file) {
     ClassProject::BDD_ID BDD_node;
 
-    std::filesystem::path pathToBenchFile(benchmark_file);
-    if (!pathToBenchFile.has_filename())
-        throw std::runtime_error("circuit_to_BDD_manager::GenerateBDD: benchmark_file not specified");
-    if (!std::filesystem::exists(benchmark_file))
-        throw std::runtime_error("circuit_to_BDD_manager::GenerateBDD: benchmark_file doesn't exist");
-    result_dir = "results_" + pathToBenchFile.stem().string();
-
-    if (!(std::filesystem::exists(result_dir)) && !std::filesystem::create_directory(result_dir)) {
-        throw std::runtime_error("Unable to create directory 'result' for the output!");
-    }
+    SetResultDir(benchmark_file);
 
     std::ofstream bdd_out_file(result_dir + "/BNode_BDD.csv");
 
@@ -36,6 +29,13 @@ void CircuitToBDD::GenerateBDD(const list_of_circuit_t &circuit, const std::stri
 
     bdd_out_file << "BDD_ID,Bench Label" << std::endl;
 
+    /* OUTPUT and FLIP FLOP gates count as fanouts that are never consumed, so their drivers stay rooted */
+    for (const auto &circuit_node : circuit) {
+        for (const auto &input_id : circuit_node.input_id_list) {
+            pending_fanouts[input_id]++;
+        }
+    }
+
     for (const auto &circuit_node : circuit) {
         if (circuit_node.gate_type == INPUT_GATE_T) {
             BDD_node = InputGate(circuit_node.label);
@@ -60,6 +60,14 @@ void CircuitToBDD::GenerateBDD(const list_of_circuit_t &circuit, const std::stri
             node_to_bdd_id.insert(std::pair<unique_ID_t, ClassProject::BDD_ID>(circuit_node.id, BDD_node));
             label_to_bdd_id.insert(std::pair<label_t, ClassProject::BDD_ID>(circuit_node.label, BDD_node));
             bdd_out_file << BDD_node << "," << circuit_node.label << std::endl;
+
+            /* Root the gate and release its inputs once their last fanout is built */
+            live_bdds.emplace(circuit_node.id, ClassProject::BDDHandle(*bdd_manager, BDD_node));
+            for (const auto &input_id : circuit_node.input_id_list) {
+                if (--pending_fanouts[input_id] == 0) {
+                    live_bdds.erase(input_id);
+                }
+            }
         }
     }
 
@@ -67,6 +75,48 @@ void CircuitToBDD::GenerateBDD(const list_of_circuit_t &circuit, const std::stri
 }
 
 
+void CircuitToBDD::SetResultDir(const std::string &benchmark_file) {
+    std::filesystem::path pathToBenchFile(benchmark_file);
+    if (!pathToBenchFile.has_filename())
+        throw std::runtime_error("circuit_to_BDD_manager::GenerateBDD: benchmark_file not specified");
+    if (!std::filesystem::exists(benchmark_file))
+        throw std::runtime_error("circuit_to_BDD_manager::GenerateBDD: benchmark_file doesn't exist");
+    result_dir = "results_" + pathToBenchFile.stem().string();
+
+    if (!(std::filesystem::exists(result_dir)) && !std::filesystem::create_directory(result_dir)) {
+        throw std::runtime_error("Unable to create directory 'result' for the output!");
+    }
+}
+
+
+void CircuitToBDD::SaveSnapshot(const std::string &snapshot_file, const std::set<label_t> &output_labels) {
+    std::map<std::string, ClassProject::BDD_ID> roots;
+    for (const auto &output_label : output_labels) {
+        auto output_id_it = label_to_bdd_id.find(output_label);
+        if (output_id_it == label_to_bdd_id.end()) {
+            throw std::runtime_error("Destination node UUID is not part of the circuit graph!");
+        }
+        roots[output_label] = output_id_it->second;
+    }
+    bdd_manager->save(snapshot_file, roots);
+}
+
+
+std::set<label_t> CircuitToBDD::LoadSnapshot(const std::string &snapshot_file, const std::string &benchmark_file) {
+    SetResultDir(benchmark_file);
+
+    std::set<label_t> output_labels;
+    for (const auto &root : bdd_manager->load(snapshot_file)) {
+        label_to_bdd_id[root.first] = root.second;
+        output_roots.emplace_back(*bdd_manager, root.second);
+        output_labels.insert(root.first);
+    }
+    input_count = bdd_manager->getVariableOrder().size();
+
+    return output_labels;
+}
+
+
 ClassProject::BDD_ID CircuitToBDD::findBddId(unique_ID_t circuit_node) {
 
     auto bdd_id_it = node_to_bdd_id.find(circuit_node);
@@ -80,6 +130,7 @@ ClassProject::BDD_ID CircuitToBDD::findBddId(unique_ID_t circuit_node) {
 
 
 ClassProject::BDD_ID CircuitToBDD::InputGate(const label_t &label) {
+    input_count++;
     return bdd_manager->createVar(label);
 }
 
@@ -90,119 +141,40 @@ ClassProject::BDD_ID CircuitToBDD::NotGate(const set_of_circuit_t &inputNodes) {
 }
 
 
-ClassProject::BDD_ID CircuitToBDD::AndGate(set_of_circuit_t inputNodes) {
-    auto it = inputNodes.begin();
-    ClassProject::BDD_ID first_op, second_op;
-
-    /* Get the ClassProject::BDD_ID of first elements */
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    while (!inputNodes.empty()) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
-
-        first_op = bdd_manager->and2(first_op, second_op);
+std::vector<ClassProject::BDD_ID> CircuitToBDD::findBddIds(const set_of_circuit_t &inputNodes) {
+    std::vector<ClassProject::BDD_ID> operands;
+    operands.reserve(inputNodes.size());
+    for (const auto &input_id : inputNodes) {
+        operands.push_back(findBddId(input_id));
     }
-
-    /* Return the ClassProject::BDD_ID equivalent to the AND of all inputs */
-    return first_op;
+    return operands;
 }
 
 
-ClassProject::BDD_ID CircuitToBDD::OrGate(set_of_circuit_t inputNodes) {
-    auto it = inputNodes.begin();
-    ClassProject::BDD_ID first_op, second_op;
-
-    /* Get the ClassProject::BDD_ID of first elements */
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    while (!inputNodes.empty()) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
+ClassProject::BDD_ID CircuitToBDD::AndGate(const set_of_circuit_t &inputNodes) {
+    /* Return the ClassProject::BDD_ID equivalent to the AND of all inputs */
+    return bdd_manager->andN(findBddIds(inputNodes));
+}
 
-        first_op = bdd_manager->or2(first_op, second_op);
-    }
 
+ClassProject::BDD_ID CircuitToBDD::OrGate(const set_of_circuit_t &inputNodes) {
     /* Return the ClassProject::BDD_ID equivalent to the OR of all inputs */
-    return first_op;
+    return bdd_manager->orN(findBddIds(inputNodes));
 }
 
-ClassProject::BDD_ID CircuitToBDD::NandGate(set_of_circuit_t inputNodes) {
-    auto it = inputNodes.begin();
-    ClassProject::BDD_ID first_op, second_op;
-
-    /* Get the ClassProject::BDD_ID of first elements */
-    it = inputNodes.begin();
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    if (inputNodes.size() == 1) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
-
-        /* Create the NAND BDD node for the first two elements */
-        first_op = bdd_manager->nand2(first_op, second_op);
-    } else {
-        /* AND of all inputs, to use as the second operator of the NAND gate */
-        second_op = AndGate(inputNodes);
-        /* Create the NAND BDD node */
-        first_op = bdd_manager->nand2(first_op, second_op);
-    }
-
+ClassProject::BDD_ID CircuitToBDD::NandGate(const set_of_circuit_t &inputNodes) {
     /* Return the ClassProject::BDD_ID equivalent to the NAND of all inputs */
-    return first_op;
+    return bdd_manager->neg(bdd_manager->andN(findBddIds(inputNodes)));
 }
 
-ClassProject::BDD_ID CircuitToBDD::NorGate(set_of_circuit_t inputNodes) {
-    auto it = inputNodes.begin();
-    ClassProject::BDD_ID first_op, second_op;
-
-    /* Get the ClassProject::BDD_ID of first elements */
-    it = inputNodes.begin();
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    if (inputNodes.size() == 1) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
-
-        /* Create the NOR BDD node for the first two elements */
-        first_op = bdd_manager->nor2(first_op, second_op);
-    } else {
-        /* OR of all inputs, to use as the second operator of the NAND gate */
-        second_op = OrGate(inputNodes);
-        /* Create the NOR BDD node */
-        first_op = bdd_manager->nor2(first_op, second_op);
-    }
-
+ClassProject::BDD_ID CircuitToBDD::NorGate(const set_of_circuit_t &inputNodes) {
     /* Return the ClassProject::BDD_ID equivalent to the NOR of all inputs */
-    return first_op;
+    return bdd_manager->neg(bdd_manager->orN(findBddIds(inputNodes)));
 }
 
-ClassProject::BDD_ID CircuitToBDD::XorGate(set_of_circuit_t inputNodes) {
-    auto it = inputNodes.begin();
-    ClassProject::BDD_ID first_op, second_op;
-
-    /* Get the ClassProject::BDD_ID of first elements */
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    while (!inputNodes.empty()) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
-
-        first_op = bdd_manager->xor2(first_op, second_op);
-    }
-
+ClassProject::BDD_ID CircuitToBDD::XorGate(const set_of_circuit_t &inputNodes) {
     /* Return the ClassProject::BDD_ID equivalent to the XOR of all inputs */
-    return first_op;
+    return bdd_manager->xorN(findBddIds(inputNodes));
 }
 
 void CircuitToBDD::PrintBDD(const std::set<label_t> &output_labels) {
@@ -230,10 +202,9 @@ void CircuitToBDD::PrintBDD(const std::set<label_t> &output_labels) {
                 throw std::runtime_error("Unable to open Log File!");
             }
 
-            output_nodes.clear();
-            output_vars.clear();
-            bdd_manager->findNodes(output_id_it->second, output_nodes);
-            bdd_manager->findVars(output_id_it->second, output_vars);
+            output_nodes = bdd_manager->findNodes(output_id_it->second);
+            output_vars = bdd_manager->findVars(output_id_it->second);
+            numberNodes(output_id_it->second);
 
             dumpBddText(bdd_out_txt_file);
             dumpBddDot(bdd_out_dot_file);
@@ -247,46 +218,162 @@ void CircuitToBDD::PrintBDD(const std::set<label_t> &output_labels) {
     }
 }
 
+void CircuitToBDD::PrintCoverage(const std::set<label_t> &output_labels) {
+
+    std::ofstream coverage_file(result_dir + "/coverage.csv");
+
+    if (!coverage_file.is_open()) {
+        throw std::runtime_error("Unable to open Log File!");
+    }
+
+    coverage_file << "Output Label,Satisfying Input Patterns,Coverage" << std::endl;
+
+    for (const auto &output_label : output_labels) {
+
+        auto output_id_it = label_to_bdd_id.find(output_label);
+
+        if (output_id_it == label_to_bdd_id.end()) {
+            throw std::runtime_error("Destination node UUID is not part of the circuit graph!");
+        }
+
+        ClassProject::BDD_ID output = output_id_it->second;
+        double coverage = std::exp2(bdd_manager->satCountLog2(output, input_count) - input_count);
+        coverage_file << output_label << "," << bdd_manager->satCountExact(output, input_count).toString()
+                      << "," << coverage << std::endl;
+    }
+
+    coverage_file.close();
+}
+
+void CircuitToBDD::PrintStats() {
+
+    std::ofstream stats_file(result_dir + "/stats.json");
+
+    if (!stats_file.is_open()) {
+        throw std::runtime_error("Unable to open Log File!");
+    }
+
+    ClassProject::Manager::Stats stats = bdd_manager->stats();
+    const ClassProject::UniqueTable::Stats &unique_table = stats.uniqueTable;
+    const ClassProject::ComputedTable::Stats &computed_table = stats.computedTable;
+
+    stats_file << "{" << std::endl
+               << "  \"calls\": {" << std::endl
+               << "    \"ite\": " << stats.ite << "," << std::endl
+               << "    \"and2\": " << stats.and2 << "," << std::endl
+               << "    \"xor2\": " << stats.xor2 << "," << std::endl
+               << "    \"coFactor\": " << stats.coFactor << "," << std::endl
+               << "    \"restrict\": " << stats.restrict << "," << std::endl
+               << "    \"andExists\": " << stats.andExists << "," << std::endl
+               << "    \"compose\": " << stats.compose << "," << std::endl
+               << "    \"naryOperations\": " << stats.naryOperations << std::endl
+               << "  }," << std::endl
+               << "  \"recursiveCalls\": " << stats.recursiveCalls << "," << std::endl
+               << "  \"terminalCases\": " << stats.terminalCases << "," << std::endl
+               << "  \"standardTriples\": " << stats.standardTriples << "," << std::endl
+               << "  \"maxDepth\": " << stats.maxDepth << "," << std::endl
+               << "  \"peakNodes\": " << stats.peakNodes << "," << std::endl
+               << "  \"uniqueTable\": {" << std::endl
+               << "    \"size\": " << unique_table.size << "," << std::endl
+               << "    \"capacity\": " << unique_table.capacity << "," << std::endl
+               << "    \"loadFactor\": " << unique_table.loadFactor << "," << std::endl
+               << "    \"lookups\": " << unique_table.lookups << "," << std::endl
+               << "    \"probes\": " << unique_table.probes << "," << std::endl
+               << "    \"averageProbeLength\": " << unique_table.averageProbeLength() << "," << std::endl
+               << "    \"maxProbeLength\": " << unique_table.maxProbeLength << std::endl
+               << "  }," << std::endl
+               << "  \"computedTable\": {" << std::endl
+               << "    \"size\": " << computed_table.size << "," << std::endl
+               << "    \"maxSize\": " << computed_table.maxSize << "," << std::endl
+               << "    \"lookups\": " << computed_table.lookups << "," << std::endl
+               << "    \"hits\": " << computed_table.hits << "," << std::endl
+               << "    \"hitRate\": " << computed_table.hitRate() << "," << std::endl
+               << "    \"insertions\": " << computed_table.insertions << "," << std::endl
+               << "    \"evictions\": " << computed_table.evictions << "," << std::endl
+               << "    \"resizes\": " << computed_table.resizes << std::endl
+               << "  }" << std::endl
+               << "}" << std::endl;
+
+    stats_file.close();
+}
+
+void CircuitToBDD::numberNodes(ClassProject::BDD_ID root) {
+    dump_order.clear();
+    dump_ids.clear();
+
+    size_t next_id = 2;
+    std::vector<std::pair<ClassProject::BDD_ID, bool>> stack = {{root, false}};
+
+    while (!stack.empty()) {
+        auto [node, expanded] = stack.back();
+        stack.pop_back();
+
+        if (dump_ids.find(node) != dump_ids.end()) {
+            continue;
+        }
+
+        if (bdd_manager->isConstant(node)) {
+            dump_ids[node] = node;
+            dump_order.push_back(node);
+        } else if (expanded) {
+            dump_ids[node] = next_id++;
+            dump_order.push_back(node);
+        } else {
+            stack.emplace_back(node, true);
+            /* high and low only read the node, a cofactor would be an operation at which
+             * the manager may collect garbage or reorder in the middle of the dump */
+            stack.emplace_back(bdd_manager->high(node), false);
+            stack.emplace_back(bdd_manager->low(node), false);
+        }
+    }
+}
+
 void CircuitToBDD::dumpBddText(std::ostream &out) {
-    for (auto it = output_nodes.rbegin(); it != output_nodes.rend(); ++it) {
+    for (auto it = dump_order.rbegin(); it != dump_order.rend(); ++it) {
         if (bdd_manager->isConstant(*it)) {
             out << "Terminal Node: " << (*it) << "\n";
         } else {
-            out << "Variable Node: " << (*it)
+            out << "Variable Node: " << dump_ids[*it]
                 << " Top Var Id: " << bdd_manager->topVar(*it)
                 << " Top Var Name: " << bdd_manager->getTopVarName(bdd_manager->topVar(*it))
-                << " Low: " << bdd_manager->coFactorFalse(*it)
-                << " High: " << bdd_manager->coFactorTrue(*it) << "\n";
+                << " Low: " << dump_ids[bdd_manager->low(*it)]
+                << " High: " << dump_ids[bdd_manager->high(*it)] << "\n";
         }
     }
 }
 
 void CircuitToBDD::dumpBddDot(std::ostream &out) {
+    /* The ranks follow the variable order of the manager, not the variable ids */
+    std::vector<ClassProject::BDD_ID> ordered_vars(output_vars.begin(), output_vars.end());
+    std::sort(ordered_vars.begin(), ordered_vars.end(), [this](ClassProject::BDD_ID a, ClassProject::BDD_ID b) {
+        return bdd_manager->getLevel(a) < bdd_manager->getLevel(b);
+    });
+
     out << "digraph BDD {\n";
     out << "center = true;\n";
     out << "{ rank = same; { node [style=invis]; \"T\" };\n";
     out << " { node [shape=box,fontsize=12]; \"0\"; }\n";
     out << "  { node [shape=box,fontsize=12]; \"1\"; }\n}\n";
-    for (const auto var : output_vars) {
+    for (const auto var : ordered_vars) {
         out << R"({ rank=same; { node [shape=plaintext,fontname="Times Italic",fontsize=12] ")"
             << bdd_manager->getTopVarName(var) << "\" };";
         for (unsigned long node : output_nodes) {
             if (bdd_manager->topVar(node) == var) {
-                out << "\"" << node << "\";";
+                out << "\"" << dump_ids[node] << "\";";
             }
         }
         out << "}\n";
     }
     out << "edge [style = invis]; {";
-    for (const auto var : output_vars) {
+    for (const auto var : ordered_vars) {
         out << "\"" << bdd_manager->getTopVarName(var) << "\" -> ";
     }
     out << "\"T\"; }\n";
     for (const auto node : output_nodes) {
         if (!bdd_manager->isConstant(node)) {
-            out << "\"" << node << "\" -> \"" << bdd_manager->coFactorTrue(node)
+            out << "\"" << dump_ids[node] << "\" -> \"" << dump_ids[bdd_manager->high(node)]
                 << "\" [style=solid,arrowsize=\".75\"];\n";
-            out << "\"" << node << "\" -> \"" << bdd_manager->coFactorFalse(node)
+            out << "\"" << dump_ids[node] << "\" -> \"" << dump_ids[bdd_manager->low(node)]
                 << "\" [style=dashed,arrowsize=\".75\"];\n";
         }
     }
@@ -47,17 +47,64 @@ public:
      */
     void PrintBDD(const std::set<label_t> &output_labels);
 
+    /**
+     * \brief Print the number and fraction of input patterns that set each output
+     * \param The set of output labels to print the coverage for
+     * \return none
+     */
+    void PrintCoverage(const std::set<label_t> &output_labels);
+
+    /**
+     * \brief Write the operation counters and table statistics of the manager as JSON
+     * \return none
+     */
+    void PrintStats();
+
+    /**
+     * \brief Save the BDDs of the outputs to a binary snapshot
+     * \param snapshot_file is the path of the snapshot
+     * \param output_labels is the set of output labels stored as named roots
+     * \return none
+     */
+    void SaveSnapshot(const std::string &snapshot_file, const std::set<label_t> &output_labels);
+
+    /**
+     * \brief Restore the BDDs of the outputs from a snapshot instead of generating them
+     * \param snapshot_file is the path of the snapshot
+     * \param benchmark_file the snapshot was generated from, names the result directory
+     * \return The set of output labels found in the snapshot
+     */
+    std::set<label_t> LoadSnapshot(const std::string &snapshot_file, const std::string &benchmark_file);
+
 private:
 
+    /* Both maps keep the ids of released gates. Once the manager collects garbage, such an id
+     * is stale and may refer to another node, only the ids rooted in live_bdds stay valid */
     std::unordered_map<unique_ID_t, ClassProject::BDD_ID> node_to_bdd_id; ///< Mapping from circuit node's unique ID to its BDD ID
     std::unordered_map<label_t, ClassProject::BDD_ID> label_to_bdd_id; ///< Mapping from node's label to its BDD ID
 
+    std::unordered_map<unique_ID_t, ClassProject::BDDHandle> live_bdds; ///< Roots of the gates whose fanouts are not built yet, and of the outputs
+    std::unordered_map<unique_ID_t, size_t> pending_fanouts; ///< Number of gates still to be built that read a circuit node
+    std::vector<ClassProject::BDDHandle> output_roots; ///< Roots of the outputs restored from a snapshot
+
     shared_ptr<ClassProject::Manager> bdd_manager{};
     std::string result_dir; ///< Directory where the results are stored
+    size_t input_count = 0; ///< Number of BDD variables created for the circuit inputs
 
-    std::set<ClassProject::BDD_ID> output_nodes;
-    std::set<ClassProject::BDD_ID> output_vars;
+    std::vector<ClassProject::BDD_ID> output_nodes;
+    std::vector<ClassProject::BDD_ID> output_vars;
 
+    std::vector<ClassProject::BDD_ID> dump_order; ///< Nodes of the printed BDD, children before parents
+    std::unordered_map<ClassProject::BDD_ID, size_t> dump_ids; ///< Id under which each node is printed
+
+
+    /**
+     * \brief Derives the result directory from the benchmark file and creates it
+     * \param benchmark_file is the path of the circuit
+     * \return none
+     *
+     */
+    void SetResultDir(const std::string &benchmark_file);
 
     /**
      * \brief Returns the BDD_ID of the given circuit ID
@@ -67,6 +114,14 @@ private:
      */
     ClassProject::BDD_ID findBddId(unique_ID_t circuit_node);
 
+    /**
+     * \brief Returns the BDD_IDs of the given circuit IDs
+     * \param inputNodes is set_of_circuit_t
+     * \return std::vector<ClassProject::BDD_ID>
+     *
+     */
+    std::vector<ClassProject::BDD_ID> findBddIds(const set_of_circuit_t &inputNodes);
+
     /**
      * \brief Generates the BDD node equivalent to a variable with label "label".
      * \param label is label_t
@@ -89,7 +144,7 @@ private:
      * \return ClassProject::BDD_ID
      *
      */
-    ClassProject::BDD_ID AndGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD_ID AndGate(const set_of_circuit_t &inputNodes);
 
     /**
      * \brief Generates the BDD node equivalent to the OR gate.
@@ -97,7 +152,7 @@ private:
      * \return ClassProject::BDD_ID
      *
      */
-    ClassProject::BDD_ID OrGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD_ID OrGate(const set_of_circuit_t &inputNodes);
 
     /**
      * \brief Generates the BDD node equivalent to the NAND gate.
@@ -105,7 +160,7 @@ private:
      * \return ClassProject::BDD_ID
      *
      */
-    ClassProject::BDD_ID NandGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD_ID NandGate(const set_of_circuit_t &inputNodes);
 
     /**
      * \brief Generates the BDD node equivalent to the NOR gate.
@@ -113,7 +168,7 @@ private:
      * \return ClassProject::BDD_ID
      *
      */
-    ClassProject::BDD_ID NorGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD_ID NorGate(const set_of_circuit_t &inputNodes);
 
     /**
      * \brief Generates the BDD node equivalent to the XOR gate.
@@ -121,7 +176,18 @@ private:
      * \return ClassProject::BDD_ID
      *
      */
-    ClassProject::BDD_ID XorGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD_ID XorGate(const set_of_circuit_t &inputNodes);
+
+    /**
+     * \brief Numbers the nodes of the BDD rooted at root for printing
+     * \param root is ClassProject::BDD_ID
+     * \return none
+     *
+     *  Complemented edges give BDD_IDs that neither fit the text format nor follow
+     *   the node order, so the dumped nodes are renumbered children first. The
+     *   terminals keep their ids and the root gets the largest one.
+     */
+    void numberNodes(ClassProject::BDD_ID root);
 
     void dumpBddText(std::ostream &out);
 
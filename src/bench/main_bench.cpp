@@ -22,22 +22,59 @@ int main(int argc, char *argv[]) {
 
     std::string bench_file = argv[1];
 
-    /* Parse the circuit from file and generate topological sorted circuit */
-    BenchParser parsed_circuit(bench_file);
+    /* Optional second argument: number of nodes that triggers a garbage collection, 0 (default) disables it.
+     * Collected ids are reused, so with collection enabled an id in BNode_BDD.csv may stand for several gates */
+    size_t gc_threshold = 0;
+    if (argc > 2) {
+        gc_threshold = std::stoul(argv[2]);
+    }
+
+    /* Optional third argument: number of nodes that triggers sifting, 0 (default) keeps the creation order */
+    size_t reorder_threshold = 0;
+    if (argc > 3) {
+        reorder_threshold = std::stoul(argv[3]);
+    }
+
+    /* Optional fourth argument: snapshot file, loaded instead of building the BDDs if it exists, written otherwise */
+    std::string snapshot_file;
+    if (argc > 4) {
+        snapshot_file = argv[4];
+    }
 
     auto BDD_manager = make_shared<ClassProject::Manager>();
+    BDD_manager->setGarbageCollectionThreshold(gc_threshold);
+    BDD_manager->setReorderThreshold(reorder_threshold);
     auto circuit2BDD = make_unique<CircuitToBDD>(BDD_manager);
 
     double user_time, vm1, rss1, vm2, rss2;
+    std::set<label_t> output_labels;
 
-    std::cout << "- Generating BDD from circuit...";
     process_mem_usage(vm1, rss1);
     user_time = userTime();
-    circuit2BDD->GenerateBDD(parsed_circuit.GetSortedCircuit(), bench_file);
-    user_time = userTime() - user_time;
-    std::cout << " BDD generated successfully!" << std::endl << std::endl;
+    if (!snapshot_file.empty() && std::filesystem::exists(snapshot_file)) {
+        std::cout << "- Loading BDD from snapshot...";
+        output_labels = circuit2BDD->LoadSnapshot(snapshot_file, bench_file);
+        user_time = userTime() - user_time;
+        std::cout << " BDD loaded successfully!" << std::endl << std::endl;
+    } else {
+        /* Parse the circuit from file and generate topological sorted circuit */
+        BenchParser parsed_circuit(bench_file);
+        output_labels = parsed_circuit.GetListOfOutputLabels();
+
+        std::cout << "- Generating BDD from circuit...";
+        user_time = userTime();
+        circuit2BDD->GenerateBDD(parsed_circuit.GetSortedCircuit(), bench_file);
+        user_time = userTime() - user_time;
+        std::cout << " BDD generated successfully!" << std::endl << std::endl;
+
+        if (!snapshot_file.empty()) {
+            circuit2BDD->SaveSnapshot(snapshot_file, output_labels);
+        }
+    }
 
-    circuit2BDD->PrintBDD(parsed_circuit.GetListOfOutputLabels());
+    circuit2BDD->PrintBDD(output_labels);
+    circuit2BDD->PrintCoverage(output_labels);
+    circuit2BDD->PrintStats();
 
     std::cout << "**** Performance ****" << std::endl;
     std::cout << " Runtime: " << user_time << std::endl;
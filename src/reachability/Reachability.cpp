@@ -1,30 +1,58 @@
 #include "Reachability.h"
 #include "../Manager.h"
+#include <algorithm>
+#include <thread>
 
 namespace ClassProject {
 
     const int Reachability::UNREACHABLE = -1;
-
-    Reachability::Reachability(unsigned int stateSize, unsigned int inputSize)    
-        : ReachabilityInterface(stateSize, inputSize)                
+    const size_t Reachability::DEFAULT_CLUSTER_THRESHOLD = 5000;
+
+    /**
+     * @brief creates the state machine with its variables in the requested order
+     *
+     * The variables are created top to bottom, so the order of creation is the variable
+     * order. Interleaving places every next state variable right below its current state
+     * variable, which keeps the relation s'_i <-> delta_i and the renaming local.
+     *
+     * @param stateSize number of state bits
+     * @param inputSize number of input bits
+     * @param order of the current and next state variables
+     * @param inputs placement of the input variables
+     */
+    Reachability::Reachability(unsigned int stateSize, unsigned int inputSize, StateOrder order, InputPlacement inputs)
+        : ReachabilityInterface(stateSize, inputSize), cluster_threshold(DEFAULT_CLUSTER_THRESHOLD)
     {
         if(stateSize <= 0)
             throw std::runtime_error("stateSize must be greater than zero");
-            
-        // create current state, next state, and input variables
+
+        input_variables = std::vector<BDD_ID>(inputSize);
+        if(inputs == INPUTS_FIRST){
+            for(unsigned int i=0; i<inputSize; i++)
+                input_variables[i] = createVar("-");
+        }
+
+        // create current state and next state variables
         state_variables = std::vector<BDD_ID>(stateSize);
-        for(int i=0; i<stateSize; i++){
+        next_state_variables = std::vector<BDD_ID>(stateSize);
+        for(unsigned int i=0; i<stateSize; i++){
             state_variables[i] = createVar("-");
+            if(order == INTERLEAVED)
+                next_state_variables[i] = createVar("-");
+        }
+        if(order == SEPARATED){
+            for(unsigned int i=0; i<stateSize; i++)
+                next_state_variables[i] = createVar("-");
         }
 
-        next_state_variables = std::vector<BDD_ID>(stateSize);
-        for(int i=0; i<stateSize; i++){
-            next_state_variables[i] = createVar("-");
+        for(unsigned int i=0; i<stateSize; i++){
+            state_index[state_variables[i]] = i;
+            next_to_current[next_state_variables[i]] = state_variables[i];
         }
 
-        input_variables = std::vector<BDD_ID>(inputSize);
-        for(int i=0; i<inputSize; i++){
-            input_variables[i] = createVar("-");
+        if(inputs == INPUTS_LAST){
+            for(unsigned int i=0; i<inputSize; i++)
+                input_variables[i] = createVar("-");
         }
 
         transition_functions = std::vector<BDD_ID>(stateSize);
@@ -48,68 +76,369 @@ namespace ClassProject {
         return input_variables;
     }
 
+    const std::vector<BDD_ID> &Reachability::getNextStates() const
+    {
+        return next_state_variables;
+    }
+
     bool Reachability::isReachable(const std::vector<bool> &stateVector)
     {
         return stateDistance(stateVector) != UNREACHABLE;
     }
 
+    /**
+     * @brief number of steps needed to reach a state from the initial state
+     *
+     * The layers of states first reached at each distance are kept between the calls,
+     * a query only extends them as far as needed and then walks a single path per layer.
+     *
+     * @param stateVector
+     * @return int distance or UNREACHABLE
+     */
     int Reachability::stateDistance(const std::vector<bool> &stateVector)
     {
         if(stateVector.size() != state_variables.size())
             throw std::runtime_error("Vector size does not match state variables");
 
-        if(stateVector == getInitState())
-            return 0;
+        for(size_t distance = 0; distance < layers.size() || extend_layers(); distance++){
+            if(contains(layers[distance], stateVector))
+                return distance;
+        }
 
-        BDD_ID tau, cs0, cr, cri, img;
-        
-        int distance = 0;
+        return UNREACHABLE;
+    }
 
-        // compute the BDD for the transition relation
-        tau = characteristic_function(next_state_variables, transition_functions);        
-        
-        // compute the characteristic function of the initial state
-        cs0 = characteristic_function(state_variables, initial_state);        
+    size_t Reachability::stateWords() const
+    {
+        return (state_variables.size() + 63) / 64;
+    }
 
-        // fixed point iteration
-        cri = cs0;
-        do {
+    /**
+     * @brief checks many packed states at once, see stateWords for the layout
+     *
+     * Runs the fixpoint once, then every state costs a single path walk of the reached
+     * states. The walks only read a flattened copy of the BDD, so they run in parallel.
+     *
+     * @param states packed states, a multiple of stateWords() words
+     * @param threads number of threads, 0 uses one per hardware thread
+     * @return std::vector<bool> one entry per state
+     */
+    std::vector<bool> Reachability::isReachableBatch(const std::vector<uint64_t> &states, unsigned int threads)
+    {
+        size_t words = stateWords();
+        if(states.size() % words != 0)
+            throw std::runtime_error("Vector size does not match state variables");
 
-            cr = cri;
+        build_paths();
+        size_t count = states.size() / words;
 
-            // compute image of next state variables (step 7)
-            img = compute_image(tau, cr);          
+        // std::vector<bool> packs its bits, so the threads write bytes
+        std::vector<uint8_t> reachable(count);
+        for_each_range(count, threads, [&](size_t begin, size_t end){
+            for(size_t r = begin; r < end; r++)
+                reachable[r] = walk(path_roots.back(), &states[r * words]);
+        });
+        return std::vector<bool>(reachable.begin(), reachable.end());
+    }
 
-            cri = this->or2(cr, img);
-            distance++;
+    /**
+     * @brief distances of many packed states at once, see stateWords for the layout
+     *
+     * The sets reached within 0, 1, 2, ... steps grow monotonically, so the distance of a
+     * state is found by a binary search over them with one path walk per probe.
+     *
+     * @param states packed states, a multiple of stateWords() words
+     * @param threads number of threads, 0 uses one per hardware thread
+     * @return std::vector<int> distance or UNREACHABLE per state
+     */
+    std::vector<int> Reachability::stateDistanceBatch(const std::vector<uint64_t> &states, unsigned int threads)
+    {
+        size_t words = stateWords();
+        if(states.size() % words != 0)
+            throw std::runtime_error("Vector size does not match state variables");
 
-            // check if the stateVector belong to the reachable state space
-            BDD_ID temp = cri;
-            for(int i=0; i<stateVector.size(); i++){
-                BDD_ID sv = stateVector[i] ? True() : False();
-                temp = this->and2(temp, this->xnor2(sv, state_variables[i]));
+        build_paths();
+        size_t count = states.size() / words;
+
+        std::vector<int> distances(count);
+        for_each_range(count, threads, [&](size_t begin, size_t end){
+            for(size_t r = begin; r < end; r++){
+                const uint64_t *state = &states[r * words];
+                if(!walk(path_roots.back(), state)){
+                    distances[r] = UNREACHABLE;
+                    continue;
+                }
+
+                size_t low = 0, high = path_roots.size() - 1;
+                while(low < high){
+                    size_t mid = (low + high) / 2;
+                    if(walk(path_roots[mid], state))
+                        high = mid;
+                    else
+                        low = mid + 1;
+                }
+                distances[r] = low;
             }
+        });
+        return distances;
+    }
+
+    /**
+     * @brief number of states reachable from the initial state, including the initial state
+     *
+     * @return double
+     */
+    double Reachability::reachableStateCount()
+    {
+        BDDHandle cr(*this, reachable_states());
+        return this->satCount(cr, state_variables.size());
+    }
+
+    BDD_ID Reachability::reachable_states()
+    {
+        while(extend_layers());
+        return reached;
+    }
 
-            // existential quantification with respect to the next state variables
-            temp = existential_quantification(temp, state_variables);    
+    /**
+     * @brief sets the number of nodes up to which the relations of the state bits are conjoined
+     *
+     * 0 keeps one cluster per state bit. The reachable layers stay valid.
+     *
+     * @param threshold
+     */
+    void Reachability::setClusterThreshold(size_t threshold)
+    {
+        cluster_threshold = threshold;
+        clusters.clear();
+        cluster_cubes.clear();
+        relation_built = false;
+    }
+
+    /**
+     * @brief number of clusters of the partitioned transition relation
+     *
+     * @return size_t
+     */
+    size_t Reachability::clusterCount()
+    {
+        build_transition_relation();
+        return clusters.size();
+    }
 
-            if(temp == True()) return distance;
+    void Reachability::build_transition_relation()
+    {
+        if(relation_built)
+            return;
+
+        std::unordered_set<BDD_ID> quantifiable(state_variables.begin(), state_variables.end());
+        quantifiable.insert(input_variables.begin(), input_variables.end());
+
+        // relation s'_i <-> delta_i of every state bit, with the variables to be quantified it depends on
+        std::vector<BDDHandle> relations;
+        std::vector<std::vector<BDD_ID>> supports;
+        std::unordered_map<BDD_ID, size_t> occurrences;
+        for(size_t i = 0; i < state_variables.size(); i++){
+            relations.emplace_back(*this, this->xnor2(next_state_variables[i], transition_functions[i]));
+            supports.emplace_back();
+            for(BDD_ID x : this->findVars(relations.back())){
+                if(quantifiable.count(x)){
+                    supports.back().push_back(x);
+                    occurrences[x]++;
+                }
+            }
+        }
 
-        } while(cri != cr);        
+        // IWLS95 style ordering: next comes the relation that lets the most variables be quantified
+        // and brings the fewest variables into the product, relative to its support
+        std::vector<size_t> order;
+        std::vector<bool> scheduled(relations.size(), false);
+        std::unordered_set<BDD_ID> introduced;
+        while(order.size() < relations.size()){
+            size_t best = 0;
+            double best_benefit = -1;
+            for(size_t i = 0; i < relations.size(); i++){
+                if(scheduled[i])
+                    continue;
+
+                double benefit = 2;
+                if(!supports[i].empty()){
+                    size_t quantified = 0, added = 0;
+                    for(BDD_ID x : supports[i]){
+                        quantified += occurrences[x] == 1;
+                        added += introduced.count(x) == 0;
+                    }
+                    benefit = (double) (quantified + supports[i].size() - added) / supports[i].size();
+                }
+                if(benefit > best_benefit){
+                    best = i;
+                    best_benefit = benefit;
+                }
+            }
 
-        return UNREACHABLE;
+            order.push_back(best);
+            scheduled[best] = true;
+            for(BDD_ID x : supports[best]){
+                occurrences[x]--;
+                introduced.insert(x);
+            }
+        }
+
+        // conjoin neighbouring relations while the cluster stays below the threshold
+        clusters.clear();
+        for(size_t i : order){
+            if(!clusters.empty()){
+                BDDHandle conjunction(*this, this->and2(clusters.back(), relations[i]));
+                if(this->nodeCount(conjunction) <= cluster_threshold){
+                    clusters.back() = conjunction;
+                    continue;
+                }
+            }
+            clusters.push_back(relations[i]);
+        }
+
+        // every variable is quantified after the last cluster it occurs in, the others up front
+        std::unordered_map<BDD_ID, size_t> last_cluster;
+        for(size_t j = 0; j < clusters.size(); j++)
+            for(BDD_ID x : this->findVars(clusters[j]))
+                if(quantifiable.count(x))
+                    last_cluster[x] = j + 1;
+
+        std::vector<std::vector<BDD_ID>> scheduled_variables(clusters.size() + 1);
+        for(BDD_ID x : quantifiable)
+            scheduled_variables[last_cluster.count(x) ? last_cluster[x] : 0].push_back(x);
+
+        leading_cube = BDDHandle(*this, this->makeCube(scheduled_variables[0]));
+        cluster_cubes.clear();
+        for(size_t j = 0; j < clusters.size(); j++)
+            cluster_cubes.emplace_back(*this, this->makeCube(scheduled_variables[j + 1]));
+
+        relation_built = true;
+    }
+
+    bool Reachability::extend_layers()
+    {
+        if(fixpoint_reached)
+            return false;
+
+        if(layers.empty()){
+            // the intermediate BDDs are rooted, so the manager may collect garbage in between
+            BDDHandle cs0(*this, characteristic_function(state_variables, initial_state));
+            layers.push_back(cs0);
+            reached = cs0;
+            return true;
+        }
+
+        // only the frontier, the states first reached in the last step, can have successors
+        // that are not reached yet. Any set between the frontier and the reached states has
+        // the same new successors, so whichever of the two has the smaller BDD is imaged.
+        // The reached states are only counted up to the size of the frontier
+        BDD_ID frontier = layers.back();
+        size_t frontier_size = this->nodeCount(frontier);
+        if(this->nodeCount(reached, frontier_size) < frontier_size)
+            frontier = reached;
+
+        BDDHandle img(*this, compute_image(frontier));
+        BDDHandle layer(*this, this->and2(img, this->neg(reached)));
+        if(layer == False()){
+            fixpoint_reached = true;
+            return false;
+        }
+
+        layers.push_back(layer);
+        reached = BDDHandle(*this, this->or2(reached, layer));
+        return true;
+    }
+
+    bool Reachability::contains(BDD_ID states, const std::vector<bool> &stateVector)
+    {
+        while(!isConstant(states)){
+            bool value = stateVector[state_index.at(topVar(states))];
+            states = value ? high(states) : low(states);
+        }
+        return states == True();
+    }
+
+    void Reachability::build_paths()
+    {
+        if(!path_roots.empty())
+            return;
+
+        while(extend_layers());
+
+        // the cumulative sets share most of their nodes, every edge is flattened once
+        std::unordered_map<BDD_ID, size_t> slot_of = {{False(), 0}, {True(), 1}};
+        std::vector<BDD_ID> edges = {False(), True()};
+        BDDHandle within;
+        for(size_t distance = 0; distance < layers.size(); distance++){
+            within = distance == 0 ? layers[0] : BDDHandle(*this, this->or2(within, layers[distance]));
+            this->visitNodes(within, [&](BDD_ID f){
+                if(slot_of.emplace(f, edges.size()).second)
+                    edges.push_back(f);
+            });
+            path_roots.push_back(slot_of.at(within));
+        }
+
+        path_nodes.resize(edges.size());
+        for(size_t slot = 2; slot < edges.size(); slot++){
+            BDD_ID f = edges[slot];
+            path_nodes[slot] = {.bit = state_index.at(topVar(f)), .low = slot_of.at(low(f)), .high = slot_of.at(high(f))};
+        }
+    }
+
+    bool Reachability::walk(size_t root, const uint64_t *state) const
+    {
+        size_t slot = root;
+        while(slot > 1){
+            const PathNode &node = path_nodes[slot];
+            slot = (state[node.bit / 64] >> (node.bit % 64)) & 1 ? node.high : node.low;
+        }
+        return slot == 1;
+    }
+
+    void Reachability::for_each_range(size_t count, unsigned int threads, const std::function<void(size_t, size_t)> &body)
+    {
+        if(threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min<size_t>(threads, std::max<size_t>(count, 1));
+
+        std::vector<std::thread> workers;
+        size_t range = (count + threads - 1) / threads;
+        for(unsigned int t = 1; t < threads; t++)
+            workers.emplace_back(body, std::min(count, t * range), std::min(count, (t + 1) * range));
+        body(0, std::min(count, range));
+        for(std::thread &worker : workers)
+            worker.join();
+    }
+
+    void Reachability::invalidate(bool transitions)
+    {
+        if(transitions){
+            clusters.clear();
+            cluster_cubes.clear();
+            relation_built = false;
+        }
+        layers.clear();
+        reached = BDDHandle();
+        fixpoint_reached = false;
+        path_nodes.clear();
+        path_roots.clear();
     }
 
     void Reachability::setTransitionFunctions(const std::vector<BDD_ID> &transitionFunctions)
     {
         for(BDD_ID id : transitionFunctions)
-            if(id < 0 || id >= uniqueTableSize())
+            if(!isValid(id))
                 throw std::runtime_error("Unknown ID found");
 
         if(transitionFunctions.size() != state_variables.size())
             throw std::runtime_error("Vector size does not match state variables");
 
         this->transition_functions = transitionFunctions;
+        transition_roots.clear();
+        for(BDD_ID id : transitionFunctions)
+            transition_roots.emplace_back(*this, id);
+        invalidate(true);
     }
 
     void Reachability::setInitState(const std::vector<bool> &stateVector)
@@ -120,6 +449,7 @@ namespace ClassProject {
         for(int i=0; i<stateVector.size(); i++){
             this->initial_state[i] = stateVector[i] ? True() : False();
         }
+        invalidate(false);
     }
 
     const std::vector<BDD_ID> Reachability::getTransitionFunctions(){
@@ -134,46 +464,41 @@ namespace ClassProject {
         return initial_state;
     }
 
-    BDD_ID Reachability::existential_quantification(BDD_ID equation, std::vector<BDD_ID> variables)
+    BDD_ID Reachability::existential_quantification(BDD_ID equation, const std::vector<BDD_ID> &variables)
     {
-        BDD_ID eq = equation;
-        for(int i=0; i<variables.size(); i++){
-            eq = this->or2(this->coFactorTrue(eq, variables[i]), this->coFactorFalse(eq, variables[i]));
-        }
-
-        return eq;
+        BDDHandle cube(*this, this->makeCube(variables));
+        return this->exists(equation, cube);
     }
 
     BDD_ID Reachability::characteristic_function(std::vector<BDD_ID> equations, std::vector<BDD_ID> variables)
     {
-        BDD_ID cs = this->xnor2(variables[0], equations[0]);
+        BDDHandle cs(*this, this->xnor2(variables[0], equations[0]));
         for(int i=1; i<equations.size(); i++){
-            cs = this->and2(
+            cs = BDDHandle(*this, this->and2(
                 cs,
                 this->xnor2(variables[i], equations[i])
-            );
+            ));
         }
 
         return cs;
     }
 
-    BDD_ID Reachability::compute_image(BDD_ID tau, BDD_ID cr)
+    BDD_ID Reachability::compute_image(BDD_ID cr)
     {
-        // compute image for next state variables
-        BDD_ID image = this->and2(tau, cr);
+        build_transition_relation();
 
-        // get rid of the input and the current state variables
-        // (we are only interested in the reached states, not how to reach them)
-        image = existential_quantification(image, state_variables);
-        image = existential_quantification(image, input_variables);
+        // conjoin the clusters one at a time, getting rid of the input and the current state
+        // variables as soon as no later cluster depends on them (we are only interested in the
+        // reached states, not how to reach them), so neither the monolithic relation nor the
+        // full conjunction is ever built
+        BDDHandle image(*this, this->exists(cr, leading_cube));
+        for(size_t j = 0; j < clusters.size(); j++)
+            image = BDDHandle(*this, this->andExists(image, clusters[j], cluster_cubes[j]));
 
         // rename the next state variables into current state variables for next iteration
-        for(int i=0; i<state_variables.size(); i++){
-            image = this->and2(image, this->xnor2(this->state_variables[i], this->next_state_variables[i]));
-        }
-        image = existential_quantification(image, next_state_variables);
+        image = BDDHandle(*this, this->compose(image, next_to_current));
 
         return image;
     }
 
-}
\ No newline at end of file
+}
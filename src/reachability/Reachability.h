@@ -4,6 +4,10 @@
 #include "ReachabilityInterface.h"
 #include "../Manager.h"
 #include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <cstdint>
 
 namespace ClassProject
 {
@@ -16,17 +20,39 @@ namespace ClassProject
       std::vector<BDD_ID> next_state_variables;
       std::vector<BDD_ID> input_variables;
       std::vector<BDD_ID> transition_functions;
+      std::vector<BDDHandle> transition_roots;
       std::vector<BDD_ID> initial_state;
+      std::unordered_map<BDD_ID, BDD_ID> next_to_current;
+      std::unordered_map<BDD_ID, size_t> state_index;
+
+      // cached by the queries, the clusters are dropped by setTransitionFunctions, the layers by both setters
+      std::vector<BDDHandle> clusters;
+      std::vector<BDDHandle> cluster_cubes;
+      BDDHandle leading_cube;
+      size_t cluster_threshold;
+      std::vector<BDDHandle> layers;
+      BDDHandle reached;
+      bool relation_built = false;
+      bool fixpoint_reached = false;
+
+      // flattened copy of the sets reached within 0, 1, 2, ... steps for the batch queries,
+      // slot 0 is the false and slot 1 the true terminal
+      struct PathNode{
+         size_t bit;
+         size_t low, high;
+      };
+      std::vector<PathNode> path_nodes;
+      std::vector<size_t> path_roots;
 
       /**
        * @brief computes the existential quantification of an equation, given by its BDD
-       * with respect to a set variables
+       * with respect to a set variables, in a single pass over the equation
        *
        * @param formula
        * @param variables
        * @return BDD_ID
        */
-      BDD_ID existential_quantification(BDD_ID equation, std::vector<BDD_ID> variables);
+      BDD_ID existential_quantification(BDD_ID equation, const std::vector<BDD_ID> &variables);
 
       /**
        * @brief computes the characteristic function of a set of equations in terms of
@@ -39,26 +65,130 @@ namespace ClassProject
       BDD_ID characteristic_function(std::vector<BDD_ID> equations, std::vector<BDD_ID> variables);
 
       /**
-       * @brief computes the characteristic function of the image (next state set) starting from the characteristic functions
-       * of both the state state (current state set) and the transition relation
+       * @brief computes the characteristic function of the image (next state set) starting from the characteristic function
+       * of the state set (current state set) and the clusters of the transition relation
        *
        * it also renames the next state variables into current state variables
        *
-       * @param transition_relation
-       * @param initial_state
+       * @param starting_state
+       * @return BDD_ID
+       */
+      BDD_ID compute_image(BDD_ID starting_state);
+
+      /**
+       * @brief computes the characteristic function of all states reachable from the initial state
+       *
        * @return BDD_ID
        */
-      BDD_ID compute_image(BDD_ID transition_relation, BDD_ID starting_state);
+      BDD_ID reachable_states();
+
+      /**
+       * @brief builds the clusters of the transition relation and their quantification schedule on first use
+       *
+       * the relations of the state bits are ordered with an IWLS95 style heuristic, then
+       * neighbouring relations are conjoined as long as the cluster stays below the threshold.
+       * Every state and input variable is quantified right after the last cluster it occurs in.
+       */
+      void build_transition_relation();
+
+      /**
+       * @brief adds the layer of the states first reached one step after the last layer
+       *
+       * starts with the initial state as layer 0
+       *
+       * @return bool stating if a new layer was added, false once the fixpoint is reached
+       */
+      bool extend_layers();
+
+      /**
+       * @brief checks if a state lies in a set of states by following a single path
+       *
+       * @param states characteristic function over the state variables
+       * @param stateVector
+       * @return bool
+       */
+      bool contains(BDD_ID states, const std::vector<bool> &stateVector);
+
+      /**
+       * @brief flattens the sets reached within each distance into path_nodes on first use
+       *
+       * runs the fixpoint, the table refers to state bits only, so it stays valid when the
+       * manager reorders or collects garbage
+       */
+      void build_paths();
+
+      /**
+       * @brief follows the path of a packed state from a root of path_nodes, touching no manager data
+       *
+       * @param root slot of the set
+       * @param state first word of the packed state
+       * @return bool
+       */
+      bool walk(size_t root, const uint64_t *state) const;
+
+      /**
+       * @brief runs body on contiguous ranges of the count states, one range per thread
+       *
+       * @param count number of states
+       * @param threads number of threads, 0 uses one per hardware thread
+       * @param body called with the first and one past the last state of a range
+       */
+      static void for_each_range(size_t count, unsigned int threads, const std::function<void(size_t, size_t)> &body);
+
+      /**
+       * @brief drops the reachable layers, and the transition relation if requested
+       *
+       * @param transitions
+       */
+      void invalidate(bool transitions);
 
    public:
       const static int UNREACHABLE;
+      const static size_t DEFAULT_CLUSTER_THRESHOLD;
+
+      /**
+       * @brief order of the current and next state variables
+       *
+       * INTERLEAVED places every next state variable right below its current state variable,
+       * SEPARATED places all next state variables below all current state variables
+       */
+      enum StateOrder{
+         INTERLEAVED,
+         SEPARATED
+      };
+
+      /**
+       * @brief placement of the input variables, above or below all state variables
+       */
+      enum InputPlacement{
+         INPUTS_FIRST,
+         INPUTS_LAST
+      };
 
-      explicit Reachability(unsigned int stateSize, unsigned int inputSize = 0);
+      /**
+       * @brief any other order can be installed afterwards with setVariableOrder, using
+       * getStates, getNextStates and getInputs
+       */
+      explicit Reachability(unsigned int stateSize, unsigned int inputSize = 0,
+                            StateOrder order = INTERLEAVED, InputPlacement inputs = INPUTS_FIRST);
       ~Reachability() {}
       const std::vector<BDD_ID> &getStates() const;
       const std::vector<BDD_ID> &getInputs() const;
+      const std::vector<BDD_ID> &getNextStates() const;
       bool isReachable(const std::vector<bool> &stateVector);
       int stateDistance(const std::vector<bool> &stateVector);
+
+      /**
+       * @brief number of 64 bit words a state occupies in the packed layout of the batch queries
+       *
+       * state r of a batch starts at word r * stateWords(), its bit i is bit i % 64 of word i / 64
+       */
+      size_t stateWords() const;
+      std::vector<bool> isReachableBatch(const std::vector<uint64_t> &states, unsigned int threads = 1);
+      std::vector<int> stateDistanceBatch(const std::vector<uint64_t> &states, unsigned int threads = 1);
+      double reachableStateCount();
+      void setClusterThreshold(size_t threshold);
+      size_t clusterCount();
       void setTransitionFunctions(const std::vector<BDD_ID> &transitionFunctions);
       void setInitState(const std::vector<bool> &stateVector);
       const std::vector<BDD_ID> getTransitionFunctions();
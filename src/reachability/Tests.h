@@ -168,6 +168,242 @@ TEST_F(ReachabilityTest20, stateDistanceTestBasic){
     EXPECT_EQ(fsm->stateDistance({1, 1}), 2);
 }
 
+TEST_F(ReachabilityTest20, stateDistanceWithGarbageCollection){
+
+    BDD_ID s1 = stateVars.at(0);
+    BDD_ID s2 = stateVars.at(1);
+
+    transitionFunctions.push_back(fsm->xor2(s1,s2));
+    transitionFunctions.push_back(fsm->or2(fsm->and2(fsm->neg(s1), fsm->neg(s2)), s1));
+
+    fsm->setTransitionFunctions(transitionFunctions);
+    fsm->setInitState({false, true});
+
+    // collect at every top level operation, only rooted BDDs survive
+    fsm->setGarbageCollectionThreshold(1);
+    fsm->collectGarbage();
+
+    EXPECT_EQ(fsm->stateDistance({0, 0}), Reachability::UNREACHABLE);
+    EXPECT_EQ(fsm->stateDistance({1, 0}), 1);
+    EXPECT_EQ(fsm->stateDistance({1, 1}), 2);
+    EXPECT_EQ(fsm->stateDistance({1, 0}), 1);
+}
+
+TEST_F(ReachabilityTest20, reachableStateCount){
+
+    BDD_ID s1 = stateVars.at(0);
+    BDD_ID s2 = stateVars.at(1);
+
+    EXPECT_EQ(fsm->reachableStateCount(), 1);
+
+    transitionFunctions.push_back(fsm->xor2(s1,s2));
+    transitionFunctions.push_back(fsm->or2(fsm->and2(fsm->neg(s1), fsm->neg(s2)), s1));
+
+    fsm->setTransitionFunctions(transitionFunctions);
+    fsm->setInitState({false, true});
+
+    // {0, 0} is unreachable
+    EXPECT_EQ(fsm->reachableStateCount(), 3);
+}
+
+TEST_F(ReachabilityTest20, cachedLayers){
+
+    BDD_ID s1 = stateVars.at(0);
+    BDD_ID s2 = stateVars.at(1);
+
+    transitionFunctions.push_back(fsm->xor2(s1,s2));
+    transitionFunctions.push_back(fsm->or2(fsm->and2(fsm->neg(s1), fsm->neg(s2)), s1));
+
+    fsm->setTransitionFunctions(transitionFunctions);
+    fsm->setInitState({false, true});
+    EXPECT_EQ(fsm->stateDistance({0, 0}), Reachability::UNREACHABLE);
+
+    // once the layers are known, queries build no nodes
+    size_t nodes = fsm->uniqueTableSize();
+    EXPECT_EQ(fsm->stateDistance({1, 1}), 2);
+    EXPECT_TRUE(fsm->isReachable({1, 0}));
+    EXPECT_EQ(fsm->reachableStateCount(), 3);
+    EXPECT_EQ(fsm->uniqueTableSize(), nodes);
+
+    // both setters invalidate the layers
+    fsm->setInitState({false, false});
+    EXPECT_EQ(fsm->stateDistance({0, 0}), 0);
+    EXPECT_EQ(fsm->stateDistance({0, 1}), 1);
+
+    fsm->setTransitionFunctions({s1, s2});
+    EXPECT_EQ(fsm->stateDistance({0, 1}), Reachability::UNREACHABLE);
+    EXPECT_EQ(fsm->reachableStateCount(), 1);
+}
+
+TEST(ReachabilityTestConstructor, frontierImage){
+
+    // 5 bit LFSR, which runs through all states but 0 in an irregular order
+    ClassProject::Reachability fsm(5);
+    auto s = fsm.getStates();
+    fsm.setTransitionFunctions({fsm.xor2(s[4], s[2]), s[0], s[1], s[2], s[3]});
+    fsm.setInitState({true, false, false, false, false});
+
+    std::vector<unsigned int> sequence = {1};
+    while(sequence.size() < 31){
+        unsigned int state = sequence.back();
+        sequence.push_back(((state << 1) & 31) | (((state >> 4) ^ (state >> 2)) & 1));
+    }
+
+    // the layers are single states, the reached states alternate between smaller and
+    // larger BDDs, so both the frontier and the reached states get imaged
+    auto minterm = [&](unsigned int state){
+        BDD_ID cube = fsm.True();
+        for(size_t i = 0; i < 5; i++)
+            cube = fsm.and2(cube, (state >> i) & 1 ? s[i] : fsm.neg(s[i]));
+        return cube;
+    };
+    BDDHandle reached(fsm, fsm.False());
+    bool reached_smaller = false, frontier_smaller = false;
+    for(unsigned int state : sequence){
+        BDDHandle layer(fsm, minterm(state));
+        reached = BDDHandle(fsm, fsm.or2(reached, layer));
+        reached_smaller |= fsm.nodeCount(reached) < fsm.nodeCount(layer);
+        frontier_smaller |= fsm.nodeCount(reached) > fsm.nodeCount(layer);
+    }
+    ASSERT_TRUE(reached_smaller);
+    ASSERT_TRUE(frontier_smaller);
+
+    EXPECT_EQ(fsm.reachableStateCount(), 31);
+    for(size_t distance = 0; distance < sequence.size(); distance++){
+        std::vector<bool> state;
+        for(size_t i = 0; i < 5; i++)
+            state.push_back((sequence[distance] >> i) & 1);
+        EXPECT_EQ(fsm.stateDistance(state), int(distance));
+    }
+    EXPECT_EQ(fsm.stateDistance({false, false, false, false, false}), Reachability::UNREACHABLE);
+}
+
+TEST_F(ReachabilityTest31, partitionedTransitionRelation){
+
+    BDD_ID s1 = stateVars.at(0);
+    BDD_ID s2 = stateVars.at(1);
+    BDD_ID s3 = stateVars.at(2);
+    BDD_ID x  = inputVars.at(0);
+
+    // shift register with an input at the front and a wrap around at the end
+    fsm->setTransitionFunctions({fsm->xor2(x, s3), s1, fsm->and2(s2, fsm->neg(x))});
+    fsm->setInitState({false, false, false});
+
+    std::vector<int> distances;
+    for(size_t threshold : {size_t(0), size_t(8), Reachability::DEFAULT_CLUSTER_THRESHOLD}){
+        fsm->setClusterThreshold(threshold);
+        EXPECT_GE(fsm->clusterCount(), 1u);
+        EXPECT_LE(fsm->clusterCount(), 3u);
+        if(threshold == 0){
+            EXPECT_EQ(fsm->clusterCount(), 3);
+        }
+        if(threshold == Reachability::DEFAULT_CLUSTER_THRESHOLD){
+            EXPECT_EQ(fsm->clusterCount(), 1);
+        }
+
+        // setClusterThreshold keeps the layers, setting the initial state drops them,
+        // so they are computed again with the new clusters
+        fsm->setInitState({false, false, false});
+        for(int state = 0; state < 8; state++)
+            distances.push_back(fsm->stateDistance({bool(state & 1), bool(state & 2), bool(state & 4)}));
+        EXPECT_EQ(fsm->reachableStateCount(), 7);
+    }
+
+    // every threshold gives the same distances
+    for(size_t i = 8; i < distances.size(); i++)
+        EXPECT_EQ(distances[i], distances[i % 8]);
+    EXPECT_EQ(distances[0], 0);
+    EXPECT_EQ(distances[1], 1);
+}
+
+TEST_F(ReachabilityTest31, batchQueries){
+
+    BDD_ID s1 = stateVars.at(0);
+    BDD_ID s2 = stateVars.at(1);
+    BDD_ID s3 = stateVars.at(2);
+    BDD_ID x  = inputVars.at(0);
+
+    fsm->setTransitionFunctions({fsm->xor2(x, s3), s1, fsm->and2(s2, fsm->neg(x))});
+    fsm->setInitState({false, false, false});
+
+    // one word per state, every state twice
+    ASSERT_EQ(fsm->stateWords(), 1);
+    std::vector<uint64_t> states;
+    for(uint64_t state = 0; state < 16; state++)
+        states.push_back(state % 8);
+
+    for(unsigned int threads : {1u, 3u, 0u}){
+        std::vector<int> distances = fsm->stateDistanceBatch(states, threads);
+        std::vector<bool> reachable = fsm->isReachableBatch(states, threads);
+        ASSERT_EQ(distances.size(), 16);
+        ASSERT_EQ(reachable.size(), 16);
+        for(size_t r = 0; r < states.size(); r++){
+            std::vector<bool> state = {bool(states[r] & 1), bool(states[r] & 2), bool(states[r] & 4)};
+            EXPECT_EQ(distances[r], fsm->stateDistance(state));
+            EXPECT_EQ(reachable[r], fsm->isReachable(state));
+        }
+    }
+    EXPECT_EQ(fsm->stateDistanceBatch({7})[0], Reachability::UNREACHABLE);
+    EXPECT_TRUE(fsm->isReachableBatch({}).empty());
+
+    // a new initial state invalidates the flattened sets
+    fsm->setInitState({true, true, true});
+    EXPECT_EQ(fsm->stateDistanceBatch({7})[0], 0);
+}
+
+TEST(ReachabilityTestConstructor, batchQueriesMultipleWords){
+
+    // shift register of 70 bits, fed with an input
+    ClassProject::Reachability fsm(70, 1);
+    auto states = fsm.getStates();
+    std::vector<BDD_ID> functions = {fsm.getInputs().at(0)};
+    for(size_t i = 1; i < 70; i++)
+        functions.push_back(states[i - 1]);
+    fsm.setTransitionFunctions(functions);
+
+    ASSERT_EQ(fsm.stateWords(), 2);
+    EXPECT_THROW(fsm.stateDistanceBatch({0, 0, 0}), std::runtime_error);
+
+    // a single one in bit i is reached after i + 1 steps, two ones 63 bits apart as well
+    std::vector<uint64_t> packed = {0, 0, uint64_t(1) << 5, 0, 0, uint64_t(1) << 3, 1, uint64_t(1) << 0};
+    std::vector<int> distances = fsm.stateDistanceBatch(packed, 2);
+    EXPECT_EQ(distances, std::vector<int>({0, 6, 68, 65}));
+}
+
+TEST(ReachabilityTestConstructor, variableOrder){
+
+    ClassProject::Reachability interleaved(3, 1);
+    auto states = interleaved.getStates();
+    auto next = interleaved.getNextStates();
+    auto inputs = interleaved.getInputs();
+    ASSERT_EQ(next.size(), 3);
+    EXPECT_EQ(interleaved.getVariableOrder(),
+              std::vector<BDD_ID>({inputs[0], states[0], next[0], states[1], next[1], states[2], next[2]}));
+
+    ClassProject::Reachability separated(3, 1, ClassProject::Reachability::SEPARATED, ClassProject::Reachability::INPUTS_LAST);
+    states = separated.getStates();
+    next = separated.getNextStates();
+    inputs = separated.getInputs();
+    EXPECT_EQ(separated.getVariableOrder(),
+              std::vector<BDD_ID>({states[0], states[1], states[2], next[0], next[1], next[2], inputs[0]}));
+
+    // every order, including one installed by the caller, reaches the same states
+    ClassProject::Reachability reordered(3, 1);
+    states = reordered.getStates();
+    next = reordered.getNextStates();
+    inputs = reordered.getInputs();
+    reordered.setVariableOrder({next[2], states[2], states[1], next[1], inputs[0], next[0], states[0]});
+
+    for(ClassProject::Reachability *fsm : {&interleaved, &separated, &reordered}){
+        auto s = fsm->getStates();
+        BDD_ID x = fsm->getInputs().at(0);
+        fsm->setTransitionFunctions({fsm->xor2(x, s[2]), s[0], fsm->and2(s[1], fsm->neg(x))});
+        fsm->setInitState({false, false, false});
+        EXPECT_EQ(fsm->reachableStateCount(), 7);
+        EXPECT_EQ(fsm->stateDistance({true, true, false}), 2);
+    }
+}
+
 TEST_F(ReachabilityTest31, stateDistanceTest){
 
     BDD_ID s1 = stateVars.at(0);
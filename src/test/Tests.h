@@ -6,12 +6,34 @@
 #define VDSPROJECT_TESTS_H
 
 #include "Manager.h"
+#include "MappedStore.h"
+#include "Snapshot.h"
 #include <vector>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <cmath>
+#include <limits>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include <cstdio>
+#include <unistd.h>
 
 namespace ClassProject {
 
+    /**
+     * @brief path of a scratch file in the temporary directory, unique to the running test
+     *
+     * @param name of the file within the test
+     * @return std::string
+     */
+    inline std::string tempPath(const std::string &name){
+        const testing::TestInfo *test = testing::UnitTest::GetInstance()->current_test_info();
+        std::string file = std::string(test->test_suite_name()) + "." + test->name() + "." +
+                           std::to_string(getpid()) + "." + name;
+        return (std::filesystem::temp_directory_path() / file).string();
+    }
+
     class BasicTest : public testing::Test {
 
         protected:
@@ -69,7 +91,10 @@ namespace ClassProject {
 
     TEST_F(FunctionsTest, VisualizeBDD){
         BDD_ID s = 7;
-        testObj.visualizeBDD("visualization.md", s);
+        std::string visualization = tempPath("visualization.md");
+        testObj.visualizeBDD(visualization, s);
+        ASSERT_TRUE(std::filesystem::exists(visualization));
+        std::remove(visualization.c_str());
     }
 
     TEST_F(BasicTest, Constructor){
@@ -161,6 +186,85 @@ namespace ClassProject {
         ASSERT_EQ(testObj.uniqueTableSize(), 8);
     }
 
+    TEST_F(FunctionsTest, UniqueTableStats){
+        UniqueTable::Stats stats = testObj.uniqueTableStats();
+        ASSERT_EQ(stats.size, 8);
+        ASSERT_EQ(stats.capacity & (stats.capacity - 1), 0); // power of two
+        ASSERT_DOUBLE_EQ(stats.loadFactor, 8.0 / stats.capacity);
+        ASSERT_GE(stats.averageProbeLength(), 1.0);
+        ASSERT_GE(stats.maxProbeLength, 1);
+    }
+
+    TEST_F(FunctionsTest, ManagerStats){
+        BDD_ID a = 2, b = 3, c = 4;
+        testObj.resetStats();
+
+        ASSERT_EQ(testObj.and2(a, testObj.True()), a); // terminal case
+        BDD_ID f = testObj.ite(testObj.neg(a), b, c);  // rewritten to ite(a, c, b)
+        testObj.coFactorTrue(f, a);
+
+        Manager::Stats stats = testObj.stats();
+    #ifdef COLLECT_STATS
+        ASSERT_EQ(stats.and2, 1);
+        ASSERT_EQ(stats.ite, 1);
+        ASSERT_EQ(stats.coFactor, 1);
+        ASSERT_EQ(stats.xor2, 0);
+        ASSERT_EQ(stats.standardTriples, 1);
+        ASSERT_GE(stats.recursiveCalls, 5);
+        ASSERT_GE(stats.terminalCases, 3);
+        ASSERT_EQ(stats.maxDepth, 1);
+        ASSERT_EQ(stats.peakNodes, testObj.uniqueTableSize());
+    #else
+        ASSERT_EQ(stats.ite, 0);
+    #endif
+        ASSERT_EQ(stats.uniqueTable.size, testObj.uniqueTableSize());
+        ASSERT_EQ(stats.computedTable.lookups, testObj.computedTableStats().lookups);
+
+        testObj.resetStats();
+        ASSERT_EQ(testObj.stats().ite, 0);
+    }
+
+    TEST_F(BasicTest, UniqueTableGrowth){
+        std::vector<BDD_ID> vars;
+        for(int i = 0; i < 10000; i++)
+            vars.push_back(testObj.createVar("x" + std::to_string(i)));
+
+        std::vector<BDD_ID> ands;
+        for(size_t i = 1; i < vars.size(); i++)
+            ands.push_back(testObj.and2(vars[i-1], vars[i]));
+
+        UniqueTable::Stats stats = testObj.uniqueTableStats();
+        ASSERT_EQ(stats.size, 2 + vars.size() + ands.size());
+        ASSERT_LE(stats.loadFactor, UniqueTable::MAX_LOAD_FACTOR);
+
+        // nodes must still be found after the table was rehashed
+        for(size_t i = 1; i < vars.size(); i++)
+            ASSERT_EQ(testObj.and2(vars[i-1], vars[i]), ands[i-1]);
+        ASSERT_EQ(testObj.uniqueTableSize(), stats.size);
+    }
+
+    TEST_F(BasicTest, UniqueTableErase){
+        std::vector<BDD_ID> vars;
+        for(int i = 0; i < 2000; i++)
+            vars.push_back(testObj.createVar("x" + std::to_string(i)));
+
+        // keep every other product, so erased entries are spread over the probe clusters
+        std::vector<BDDHandle> kept;
+        for(size_t i = 1; i < vars.size(); i++){
+            BDD_ID f = testObj.and2(vars[i-1], vars[i]);
+            if(i % 2 == 0)
+                kept.emplace_back(testObj, f);
+        }
+
+        testObj.collectGarbage();
+        ASSERT_EQ(testObj.uniqueTableSize(), 2 + vars.size() + kept.size());
+
+        // the surviving nodes must still be found, no duplicate gets created
+        for(size_t i = 2; i < vars.size(); i += 2)
+            ASSERT_EQ(testObj.and2(vars[i-1], vars[i]), kept[i/2 - 1].get());
+        ASSERT_EQ(testObj.uniqueTableSize(), 2 + vars.size() + kept.size());
+    }
+
     TEST_F(FunctionsTest, NodeReturn){
         BDD_ID id_a = 2, id_b = 3, id_or_ab = 6;
         ASSERT_EQ(testObj.node(0), (Node{.low=testObj.low(0), .high=testObj.high(0), .topVar=testObj.topVar(0)}));
@@ -192,6 +296,88 @@ namespace ClassProject {
         ASSERT_EQ(id_n1, id_n2);
     }
 
+    TEST_F(FunctionsTest, ComputedTableHits){
+        BDD_ID id_a = 2, id_b = 3, id_c = 4;
+
+        testObj.ite(id_a, id_b, id_c);
+        ComputedTable::Stats before = testObj.computedTableStats();
+        testObj.ite(id_a, id_b, id_c);
+        ComputedTable::Stats after = testObj.computedTableStats();
+
+        ASSERT_EQ(after.hits, before.hits + 1);
+        ASSERT_EQ(after.misses, before.misses);
+        ASSERT_EQ(after.lookups, after.hits + after.misses);
+    }
+
+    TEST_F(FunctionsTest, ComputedTableEviction){
+        BDD_ID id_a = 2, id_b = 3, id_c = 4, id_d = 5;
+        testObj.setComputedTableSize(1, 1);
+
+        BDD_ID id_n1 = testObj.ite(id_a, id_b, id_c);
+        BDD_ID id_n2 = testObj.ite(id_b, id_c, id_d);
+
+        ComputedTable::Stats stats = testObj.computedTableStats();
+        ASSERT_EQ(stats.size, 1);
+        ASSERT_GT(stats.evictions, 0);
+
+        // evicted results are recomputed to the same node
+        ASSERT_EQ(testObj.ite(id_a, id_b, id_c), id_n1);
+        ASSERT_EQ(testObj.ite(id_b, id_c, id_d), id_n2);
+    }
+
+    TEST_F(BasicTest, ComputedTableGrowth){
+        testObj.setComputedTableSize(2, 1024);
+
+        std::vector<BDD_ID> vars;
+        for(int i = 0; i < 12; i++)
+            vars.push_back(testObj.createVar("x" + std::to_string(i)));
+
+        // rebuilding the same functions makes the cached results worth keeping
+        for(int round = 0; round < 4; round++){
+            BDD_ID f = testObj.False();
+            for(size_t i = 0; i < vars.size(); i++)
+                f = testObj.xor2(f, testObj.and2(vars[i], vars[(i + 5) % vars.size()]));
+        }
+
+        ComputedTable::Stats stats = testObj.computedTableStats();
+        ASSERT_GT(stats.size, 2);
+        ASSERT_LE(stats.size, 1024);
+        ASSERT_GT(stats.resizes, 1);
+    }
+
+    TEST_F(VariablesTest, CommutativeKernelsShareEntries){
+        BDD_ID id_a = 2, id_b = 3, id_c = 4, id_d = 5;
+        BDD_ID id_ab = testObj.or2(id_a, id_b);
+        BDD_ID id_cd = testObj.xor2(id_c, id_d);
+
+        // the swapped and the complemented forms are answered from the computed table
+        ComputedTable::Stats before = testObj.computedTableStats();
+        ASSERT_EQ(testObj.and2(id_cd, id_ab), testObj.and2(id_ab, id_cd));
+        ASSERT_EQ(testObj.xor2(id_ab, id_cd), testObj.xor2(id_cd, id_ab));
+        ASSERT_EQ(testObj.xnor2(testObj.neg(id_cd), id_ab), testObj.xor2(id_cd, id_ab));
+        ComputedTable::Stats after = testObj.computedTableStats();
+
+        ASSERT_EQ(after.hits - before.hits, 4);
+    }
+
+    TEST_F(VariablesTest, OperationTagsDoNotAlias){
+        BDD_ID id_a = 2, id_b = 3, id_c = 4, id_d = 5;
+        BDD_ID id_ab = testObj.xor2(id_a, id_b);
+        BDD_ID id_cd = testObj.xor2(id_c, id_d);
+
+        // and2 and xor2 of the same operands are stored under different tags
+        BDD_ID id_and = testObj.and2(id_ab, id_cd);
+        BDD_ID id_xor = testObj.xor2(id_ab, id_cd);
+        ASSERT_NE(id_and, id_xor);
+        ASSERT_EQ(testObj.and2(id_ab, id_cd), id_and);
+        ASSERT_EQ(testObj.xor2(id_ab, id_cd), id_xor);
+
+        // the kernels agree with the ite formulations
+        ASSERT_EQ(id_and, testObj.ite(id_ab, id_cd, 0));
+        ASSERT_EQ(id_xor, testObj.ite(id_ab, testObj.neg(id_cd), id_cd));
+        ASSERT_EQ(testObj.or2(id_ab, id_cd), testObj.ite(id_ab, 1, id_cd));
+    }
+
     TEST_F(FunctionsTest, CoFactorFalseStandard){
         ASSERT_EQ(testObj.low(0), testObj.coFactorFalse(0)); // constant node
         ASSERT_EQ(testObj.low(2), testObj.coFactorFalse(2)); // variable
@@ -216,6 +402,405 @@ namespace ClassProject {
         ASSERT_EQ(testObj.coFactorTrue(7, 5), 4); // coFactorFalse(c*d, d) = 0
     }
 
+    TEST_F(VariablesTest, CoFactorBelowTopIsCached){
+        BDD_ID id_a = 2, id_b = 3, id_c = 4, id_d = 5;
+        BDD_ID f = testObj.or2(testObj.and2(id_a, id_c), testObj.xor2(id_b, id_d));
+
+        BDD_ID f_d = testObj.coFactorTrue(f, id_d);
+        ASSERT_EQ(f_d, testObj.or2(testObj.and2(id_a, id_c), testObj.neg(id_b)));
+        ASSERT_EQ(testObj.coFactorFalse(f, id_d), testObj.or2(testObj.and2(id_a, id_c), id_b));
+
+        ComputedTable::Stats before = testObj.computedTableStats();
+        ASSERT_EQ(testObj.coFactorTrue(f, id_d), f_d);
+        ASSERT_EQ(testObj.computedTableStats().hits, before.hits + 1);
+    }
+
+    TEST_F(VariablesTest, RestrictByCube){
+        BDD_ID id_a = 2, id_b = 3, id_c = 4, id_d = 5;
+        BDD_ID f = testObj.or2(testObj.and2(id_a, id_c), testObj.xor2(id_b, id_d));
+
+        ASSERT_TRUE(testObj.isCube(testObj.True()));
+        ASSERT_FALSE(testObj.isCube(testObj.False()));
+        ASSERT_FALSE(testObj.isCube(f));
+
+        BDD_ID cube = testObj.makeCube({testObj.neg(id_d), id_a});
+        ASSERT_TRUE(testObj.isCube(cube));
+        ASSERT_EQ(cube, testObj.and2(id_a, testObj.neg(id_d)));
+
+        // f with a = 1 and d = 0 is c + b
+        ASSERT_EQ(testObj.restrict(f, cube), testObj.or2(id_c, id_b));
+        ASSERT_EQ(testObj.restrict(testObj.neg(f), cube), testObj.nor2(id_c, id_b));
+        ASSERT_EQ(testObj.restrict(f, cube), testObj.coFactorFalse(testObj.coFactorTrue(f, id_a), id_d));
+        ASSERT_EQ(testObj.restrict(f, testObj.True()), f);
+
+        EXPECT_THROW(testObj.restrict(f, f), std::invalid_argument);
+        EXPECT_THROW(testObj.makeCube({f}), std::invalid_argument);
+    }
+
+    TEST_F(VariablesTest, ExistsAndForall){
+        BDD_ID id_a = 2, id_b = 3, id_c = 4, id_d = 5;
+        BDD_ID f = testObj.or2(testObj.and2(id_a, id_c), testObj.and2(id_b, id_d));
+        BDD_ID cube = testObj.makeCube({id_a, id_d});
+
+        // exists a, d: (a c + b d) == c + b
+        ASSERT_EQ(testObj.exists(f, cube), testObj.or2(id_c, id_b));
+        // forall a: (a c + b d) == b d
+        BDD_ID cube_a = testObj.makeCube({id_a});
+        ASSERT_EQ(testObj.forall(f, cube_a), testObj.and2(id_b, id_d));
+
+        // quantifying one variable after the other gives the same result
+        BDD_ID f_a = testObj.or2(testObj.coFactorTrue(f, id_a), testObj.coFactorFalse(f, id_a));
+        ASSERT_EQ(testObj.exists(f, cube), testObj.exists(f_a, id_d));
+
+        ASSERT_EQ(testObj.exists(f, testObj.True()), f);
+        ASSERT_EQ(testObj.exists(f, testObj.makeCube({id_a, id_b, id_c, id_d})), testObj.True());
+        ASSERT_EQ(testObj.forall(f, testObj.makeCube({id_a, id_b, id_c, id_d})), testObj.False());
+        EXPECT_THROW(testObj.exists(f, f), std::invalid_argument);
+
+        // forall answers from the entry of ~exists(~f)
+        BDD_ID id_bd = testObj.and2(id_b, id_d);
+        ComputedTable::Stats before = testObj.computedTableStats();
+        ASSERT_EQ(testObj.exists(testObj.neg(f), cube_a), testObj.neg(id_bd));
+        ASSERT_EQ(testObj.computedTableStats().hits, before.hits + 1);
+    }
+
+    TEST_F(VariablesTest, AndExists){
+        BDD_ID id_a = 2, id_b = 3, id_c = 4, id_d = 5;
+        BDD_ID f = testObj.or2(id_a, id_c);
+        BDD_ID g = testObj.xor2(id_a, id_b);
+        BDD_ID cube = testObj.makeCube({id_a, id_b});
+
+        BDD_ID expected = testObj.exists(testObj.and2(f, g), cube);
+        ASSERT_EQ(testObj.andExists(f, g, cube), expected);
+        ASSERT_EQ(testObj.andExists(g, f, cube), expected);
+        ASSERT_EQ(testObj.andExists(f, testObj.True(), cube), testObj.exists(f, cube));
+        ASSERT_EQ(testObj.andExists(f, g, testObj.True()), testObj.and2(f, g));
+        ASSERT_EQ(testObj.andExists(f, testObj.neg(f), cube), testObj.False());
+
+        // exists a, b: (a == c)(b == d) a == c
+        BDD_ID h = testObj.and2(testObj.xnor2(id_a, id_c), testObj.xnor2(id_b, id_d));
+        ASSERT_EQ(testObj.andExists(h, id_a, cube), id_c);
+    }
+
+    TEST_F(VariablesTest, Compose){
+        BDD_ID id_a = 2, id_b = 3, id_c = 4, id_d = 5;
+        BDD_ID f = testObj.or2(testObj.and2(id_a, id_b), testObj.neg(id_c));
+
+        // f[a := c xor d, c := b]
+        BDD_ID g = testObj.xor2(id_c, id_d);
+        BDD_ID expected = testObj.or2(testObj.and2(g, id_b), testObj.neg(id_b));
+        ASSERT_EQ(testObj.compose(f, {{id_a, g}, {id_c, id_b}}), expected);
+        ASSERT_EQ(testObj.compose(testObj.neg(f), {{id_a, g}, {id_c, id_b}}), testObj.neg(expected));
+
+        // swapping variables against the order is no relabeling
+        ASSERT_EQ(testObj.compose(f, {{id_a, id_c}, {id_c, id_a}}),
+                  testObj.or2(testObj.and2(id_c, id_b), testObj.neg(id_a)));
+
+        ASSERT_EQ(testObj.compose(f, {}), f);
+        EXPECT_THROW(testObj.compose(f, {{g, id_a}}), std::invalid_argument);
+    }
+
+    TEST_F(VariablesTest, ComposeRelabel){
+        BDD_ID id_a = 2, id_b = 3, id_c = 4, id_d = 5;
+        BDD_ID f = testObj.xor2(id_a, testObj.and2(id_b, id_c));
+        BDD_ID expected = testObj.xor2(id_b, testObj.and2(id_c, id_d));
+
+        // an order preserving renaming only relabels the nodes, without any ite call
+        ComputedTable::Stats before = testObj.computedTableStats();
+        ASSERT_EQ(testObj.compose(f, {{id_a, id_b}, {id_b, id_c}, {id_c, id_d}}), expected);
+        ASSERT_EQ(testObj.computedTableStats().lookups, before.lookups);
+    }
+
+    TEST_F(VariablesTest, SatCount){
+        BDD_ID id_a = 2, id_b = 3, id_c = 4, id_d = 5;
+        BDD_ID f = testObj.or2(testObj.and2(id_a, id_b), testObj.xor2(id_c, id_d));
+
+        // 16 assignments, a b fails in 3 * 2 of the 8 with c == d
+        ASSERT_EQ(testObj.satCount(f, 4), 10);
+        ASSERT_EQ(testObj.satCount(testObj.neg(f), 4), 6);
+        ASSERT_EQ(testObj.satCount(f, 6), 40);
+        ASSERT_EQ(testObj.satCount(testObj.True(), 4), 16);
+        ASSERT_EQ(testObj.satCount(testObj.False(), 4), 0);
+
+        ASSERT_DOUBLE_EQ(testObj.satCountLog2(f, 4), std::log2(10));
+        ASSERT_DOUBLE_EQ(testObj.satCountLog2(testObj.neg(f), 100), std::log2(6) + 96);
+        ASSERT_EQ(testObj.satCountLog2(testObj.False(), 4), -std::numeric_limits<double>::infinity());
+
+        ASSERT_EQ(testObj.satCountExact(f, 4).toString(), "10");
+        ASSERT_EQ(testObj.satCountExact(testObj.neg(f), 4), BigUnsigned(6));
+        ASSERT_EQ(testObj.satCountExact(testObj.neg(id_d), 4), BigUnsigned(8));
+        ASSERT_EQ(testObj.satCountExact(f, 100).toString(), "792281625142643375935439503360"); // 10 * 2^96
+    }
+
+    TEST_F(BasicTest, SatCountDeepBDD){
+        // the conjunction of 2000 variables has a single satisfying assignment out of 2^2000
+        std::vector<BDD_ID> vars;
+        for(int i = 0; i < 2000; i++)
+            vars.push_back(testObj.createVar("v" + std::to_string(i)));
+        BDD_ID f = testObj.makeCube(vars);
+
+        // the fraction 2^-2000 is out of the double range, its logarithm is not
+        ASSERT_EQ(testObj.satCount(f, 2000), 0);
+        ASSERT_DOUBLE_EQ(testObj.satCountLog2(f, 2000), 0);
+        ASSERT_DOUBLE_EQ(testObj.satCountLog2(testObj.neg(f), 2000), 2000);
+        ASSERT_EQ(testObj.satCountExact(f, 2000).toString(), "1");
+
+        BigUnsigned all_but_one = testObj.satCountExact(testObj.neg(f), 2000);
+        all_but_one += 1;
+        BigUnsigned all(1);
+        all <<= 2000;
+        ASSERT_EQ(all_but_one, all);
+    }
+
+    TEST_F(VariablesTest, CubeEnumeration){
+        BDD_ID id_a = 2, id_b = 3, id_c = 4;
+        BDD_ID f = testObj.or2(testObj.and2(id_a, id_b), id_c);
+
+        std::vector<BDD_ID> cube;
+        ASSERT_FALSE(testObj.pickOneCube(testObj.False(), cube));
+        ASSERT_TRUE(testObj.pickOneCube(f, cube));
+        ASSERT_EQ(cube, (std::vector<BDD_ID>{id_a, id_b}));
+
+        // the cubes are disjoint and cover f
+        std::vector<std::vector<BDD_ID>> cubes;
+        BDD_ID cover = testObj.False();
+        double count = 0;
+        for(CubeIterator it(testObj, f); !it.done(); ++it){
+            cubes.push_back(*it);
+            BDD_ID c = testObj.makeCube(*it);
+            ASSERT_EQ(testObj.and2(cover, c), testObj.False());
+            cover = testObj.or2(cover, c);
+            count += testObj.satCount(c, 4);
+        }
+        ASSERT_EQ(cover, f);
+        ASSERT_EQ(count, testObj.satCount(f, 4));
+        ASSERT_EQ(cubes.size(), 3);
+
+        CubeIterator all(testObj, testObj.True());
+        ASSERT_FALSE(all.done());
+        ASSERT_TRUE((*all).empty());
+        ASSERT_TRUE((++all).done());
+    }
+
+    TEST_F(VariablesTest, NaryOperations){
+        BDD_ID id_a = 2, id_b = 3, id_c = 4, id_d = 5;
+        BDD_ID id_cd = testObj.xor2(id_c, id_d);
+        std::vector<BDD_ID> operands{id_a, testObj.neg(id_b), id_cd, id_d};
+
+        ASSERT_EQ(testObj.andN(operands), testObj.and2(testObj.and2(id_a, testObj.neg(id_b)), testObj.and2(id_cd, id_d)));
+        ASSERT_EQ(testObj.orN(operands), testObj.or2(testObj.or2(id_a, testObj.neg(id_b)), testObj.or2(id_cd, id_d)));
+        ASSERT_EQ(testObj.xorN(operands), testObj.xor2(testObj.xor2(id_a, testObj.neg(id_b)), id_c));
+
+        ASSERT_EQ(testObj.andN({}), testObj.True());
+        ASSERT_EQ(testObj.orN({}), testObj.False());
+        ASSERT_EQ(testObj.xorN({}), testObj.False());
+        ASSERT_EQ(testObj.andN({id_cd}), id_cd);
+        ASSERT_EQ(testObj.andN({id_a, id_b, testObj.neg(id_a), id_cd}), testObj.False());
+        EXPECT_THROW(testObj.andN({id_a, 1000}), std::invalid_argument);
+    }
+
+    TEST_F(BasicTest, NaryOperationsWithGarbageCollection){
+        std::vector<BDD_ID> vars, operands;
+        for(int i = 0; i < 12; i++)
+            vars.push_back(testObj.createVar("v" + std::to_string(i)));
+        for(int i = 0; i < 6; i++)
+            operands.push_back(testObj.xor2(vars[i], vars[11 - i]));
+
+        std::vector<BDDHandle> roots;
+        for(BDD_ID f : operands)
+            roots.emplace_back(testObj, f);
+
+        BDDHandle chain(testObj, operands[0]);
+        for(int i = 1; i < 6; i++)
+            chain = BDDHandle(testObj, testObj.and2(chain, operands[i]));
+
+        // intermediate results of the reduction survive collections at every operation
+        testObj.setGarbageCollectionThreshold(1);
+        ASSERT_EQ(testObj.andN(operands), chain);
+
+        // with complement edges the xor of two variables needs a single node per variable
+        ASSERT_EQ(testObj.nodeCount(operands[0]), 2);
+        ASSERT_EQ(testObj.nodeCount(testObj.True()), 0);
+
+        // the bounded count stops at the limit
+        ASSERT_EQ(testObj.nodeCount(operands[0], 1), 1);
+        ASSERT_EQ(testObj.nodeCount(operands[0], 5), 2);
+        ASSERT_EQ(testObj.nodeCount(testObj.neg(operands[0]), 5), 2);
+    }
+
+    TEST_F(VariablesTest, SnapshotSaveAndLoad){
+        BDD_ID id_a = 2, id_b = 3, id_c = 4, id_d = 5;
+        testObj.and2(id_a, testObj.xor2(id_b, id_c));
+        BDD_ID f = testObj.or2(testObj.and2(id_a, id_b), testObj.xor2(id_c, id_d));
+        BDD_ID g = testObj.neg(testObj.and2(id_b, id_d));
+
+        // leave free slots behind, the snapshot keeps the ids as they are
+        BDDHandle root_f(testObj, f), root_g(testObj, g);
+        testObj.collectGarbage();
+        testObj.setVariableOrder({id_d, id_c, id_b, id_a});
+        std::string snapshot = tempPath("snapshot.bdd");
+        testObj.save(snapshot, {{"f", f}, {"g", g}});
+
+        Manager loaded;
+        std::map<std::string, BDD_ID> roots = loaded.load(snapshot);
+        std::remove(snapshot.c_str());
+        ASSERT_EQ(roots.size(), 2);
+        ASSERT_EQ(roots["f"], f);
+        ASSERT_EQ(roots["g"], g);
+        ASSERT_EQ(loaded.uniqueTableSize(), testObj.uniqueTableSize());
+        ASSERT_EQ(loaded.getVariableOrder(), testObj.getVariableOrder());
+        ASSERT_EQ(loaded.getTopVarName(id_c), "c");
+
+        // the unique table finds the loaded nodes again
+        ASSERT_EQ(loaded.or2(loaded.and2(id_a, id_b), loaded.xor2(id_c, id_d)), f);
+        ASSERT_EQ(loaded.nand2(id_b, id_d), g);
+        ASSERT_EQ(loaded.satCount(f, 4), testObj.satCount(f, 4));
+        ASSERT_EQ(loaded.satCount(loaded.and2(f, g), 4), testObj.satCount(testObj.and2(f, g), 4));
+    }
+
+    TEST_F(BasicTest, SnapshotErrors){
+        BDD_ID a = testObj.createVar("a");
+        std::string snapshot = tempPath("snapshot.bdd"), garbage = tempPath("garbage.bdd");
+        EXPECT_THROW(testObj.save(snapshot, {{"x", 1000}}), std::invalid_argument);
+        EXPECT_THROW(testObj.load(tempPath("missing.bdd")), std::runtime_error);
+
+        std::ofstream(garbage) << "not a snapshot";
+        EXPECT_THROW(testObj.load(garbage), std::runtime_error);
+        std::remove(garbage.c_str());
+
+        testObj.save(snapshot, {{"a", a}});
+        {
+            BDDHandle root(testObj, a);
+            EXPECT_THROW(testObj.load(snapshot), std::logic_error);
+        }
+        BDD_ID loaded = testObj.load(snapshot).at("a");
+        std::remove(snapshot.c_str());
+        ASSERT_EQ(loaded, a);
+    }
+
+    TEST_F(VariablesTest, EvaluateBatch){
+        BDD_ID id_a = 2, id_b = 3, id_c = 4, id_d = 5;
+        BDD_ID f = testObj.or2(testObj.and2(id_a, id_b), testObj.xor2(id_c, id_d));
+        BDD_ID g = testObj.neg(testObj.and2(id_b, id_d));
+        std::vector<BDD_ID> roots = {f, g, testObj.neg(f), testObj.True(), testObj.False(), id_c};
+
+        // 1000 pseudo-random assignments, which leaves the last word partially used
+        const size_t words = 16;
+        std::vector<std::vector<uint64_t>> assignments(6);
+        uint64_t state = 0x9E3779B97F4A7C15ULL;
+        for(BDD_ID x : {id_a, id_b, id_c, id_d}){
+            for(size_t w = 0; w < words; w++){
+                state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+                assignments[x].push_back(state);
+            }
+        }
+
+        std::vector<std::vector<uint64_t>> results = testObj.evaluateBatch(roots, assignments);
+        ASSERT_EQ(results.size(), roots.size());
+        for(size_t r = 0; r < roots.size(); r++){
+            ASSERT_EQ(results[r].size(), words);
+            for(size_t j = 0; j < 1000; j++){
+                std::vector<BDD_ID> literals;
+                for(BDD_ID x : {id_a, id_b, id_c, id_d})
+                    literals.push_back(assignments[x][j / 64] >> (j % 64) & 1 ? x : testObj.neg(x));
+                bool expected = testObj.restrict(roots[r], testObj.makeCube(literals)) == testObj.True();
+                ASSERT_EQ(results[r][j / 64] >> (j % 64) & 1, expected);
+            }
+        }
+        ASSERT_EQ(testObj.evaluateBatch(g, assignments), results[1]);
+
+        // a does not occur in g, the variables of the support need values
+        assignments[id_a].clear();
+        ASSERT_EQ(testObj.evaluateBatch(g, assignments), results[1]);
+        EXPECT_THROW(testObj.evaluateBatch(f, assignments), std::invalid_argument);
+    }
+
+    TEST_F(VariablesTest, MappedStore){
+        BDD_ID id_a = 2, id_b = 3, id_c = 4, id_d = 5;
+        testObj.and2(id_a, testObj.xor2(id_b, id_c));
+        BDD_ID f = testObj.or2(testObj.and2(id_a, id_b), testObj.xor2(id_c, id_d));
+        BDD_ID g = testObj.neg(testObj.and2(id_b, id_d));
+
+        BDDHandle root_f(testObj, f), root_g(testObj, g);
+        testObj.collectGarbage();
+        std::string snapshot = tempPath("snapshot.bdd"), garbage = tempPath("garbage.bdd");
+        testObj.save(snapshot, {{"f", f}, {"g", g}});
+
+        MappedStore store(snapshot);
+        ASSERT_EQ(store.roots().at("f"), f);
+        ASSERT_EQ(store.roots().at("g"), g);
+        ASSERT_GT(store.size(), testObj.uniqueTableSize()); // free slots are mapped as well
+        ASSERT_TRUE(store.isVariable(id_c));
+        ASSERT_FALSE(store.isVariable(f));
+        ASSERT_EQ(store.getTopVarName(g), testObj.getTopVarName(g));
+
+        for(BDD_ID root : {f, g}){
+            std::set<BDD_ID> mapped_nodes, nodes, mapped_vars, vars;
+            store.findNodes(root, mapped_nodes);
+            testObj.findNodes(root, nodes);
+            ASSERT_EQ(mapped_nodes, nodes);
+            store.findVars(root, mapped_vars);
+            testObj.findVars(root, vars);
+            ASSERT_EQ(mapped_vars, vars);
+
+            for(BDD_ID node : nodes){
+                ASSERT_EQ(store.topVar(node), testObj.topVar(node));
+                ASSERT_EQ(store.high(node), testObj.high(node));
+                ASSERT_EQ(store.low(node), testObj.low(node));
+            }
+
+            for(int assignment = 0; assignment < 16; assignment++){
+                std::vector<bool> values(6, false);
+                std::vector<BDD_ID> literals;
+                for(BDD_ID x : {id_a, id_b, id_c, id_d}){
+                    values[x] = assignment >> (x - id_a) & 1;
+                    literals.push_back(values[x] ? x : testObj.neg(x));
+                }
+                bool expected = testObj.restrict(root, testObj.makeCube(literals)) == testObj.True();
+                ASSERT_EQ(store.evaluate(root, values), expected);
+            }
+        }
+
+        // the mapping outlives the manager and moves along with the store
+        MappedStore moved = std::move(store);
+        ASSERT_EQ(moved.topVar(f), testObj.topVar(f));
+        EXPECT_THROW(moved.evaluate(f, {}), std::out_of_range);
+
+        EXPECT_THROW(moved.topVar(moved.size()), std::out_of_range);
+
+        EXPECT_THROW(MappedStore(tempPath("missing.bdd")), std::runtime_error);
+        std::ofstream(garbage) << "not a snapshot, but long enough to hold a header";
+        EXPECT_THROW(MappedStore{garbage}, std::runtime_error);
+        std::remove(garbage.c_str());
+
+        // a corrupt low edge of f leads outside the table, reading it throws instead of faulting
+        BDD_ID f_index = f & ~(BDD_ID(1) << 31);
+        {
+            std::fstream file(snapshot, std::ios::in | std::ios::out | std::ios::binary);
+            uint64_t corrupt = 1000000;
+            file.seekp(Snapshot::TABLE_OFFSET + f_index * Snapshot::NODE_SIZE);
+            file.write(reinterpret_cast<const char *>(&corrupt), sizeof(corrupt));
+        }
+        MappedStore corrupted(snapshot);
+        std::remove(snapshot.c_str());
+        std::set<BDD_ID> nodes;
+        EXPECT_THROW(corrupted.topVar(corrupted.low(f_index)), std::out_of_range);
+        EXPECT_THROW(corrupted.findNodes(f_index, nodes), std::out_of_range);
+        EXPECT_THROW(corrupted.evaluate(f_index, std::vector<bool>(6, false)), std::out_of_range);
+
+        // a low edge of f pointing back to f itself makes the path cycle
+        {
+            testObj.save(snapshot, {{"f", f}});
+            std::fstream file(snapshot, std::ios::in | std::ios::out | std::ios::binary);
+            uint64_t cycle = f_index;
+            file.seekp(Snapshot::TABLE_OFFSET + f_index * Snapshot::NODE_SIZE);
+            file.write(reinterpret_cast<const char *>(&cycle), sizeof(cycle));
+        }
+        MappedStore cyclic(snapshot);
+        std::remove(snapshot.c_str());
+        EXPECT_THROW(cyclic.evaluate(f_index, std::vector<bool>(6, false)), std::runtime_error);
+    }
+
     TEST_F(FunctionsTest, GetTopVarName){
         ASSERT_EQ(testObj.getTopVarName(0), "0"); // false node
         ASSERT_EQ(testObj.getTopVarName(1), "1"); // true node
@@ -249,6 +834,34 @@ namespace ClassProject {
         ASSERT_EQ(nodes, (std::set<BDD_ID>{4,5}));
     }
 
+    TEST_F(FunctionsTest, FindNodesVector){
+        ASSERT_EQ(testObj.findNodes(7), (std::vector<BDD_ID>{0,1,5,7}));
+        ASSERT_EQ(testObj.findVars(6), (std::vector<BDD_ID>{2,3}));
+        ASSERT_EQ(testObj.findVars(testObj.True()), std::vector<BDD_ID>{});
+
+        // both polarities of a node are reported, its variable only once
+        BDD_ID f = testObj.xor2(6, 7);
+        std::set<BDD_ID> nodes, vars;
+        testObj.findNodes(f, nodes);
+        testObj.findVars(f, vars);
+        std::vector<BDD_ID> found = testObj.findNodes(f);
+        ASSERT_EQ(std::set<BDD_ID>(found.begin(), found.end()), nodes);
+        ASSERT_TRUE(std::is_sorted(found.begin(), found.end()));
+        ASSERT_EQ(testObj.findVars(f), (std::vector<BDD_ID>{2,3,4,5}));
+        ASSERT_EQ(vars, (std::set<BDD_ID>{2,3,4,5}));
+
+        size_t visited = 0;
+        testObj.visitNodes(testObj.neg(f), [&](BDD_ID g){
+            visited++;
+            ASSERT_TRUE(testObj.isValid(g));
+        });
+        ASSERT_EQ(visited, nodes.size());
+
+        std::vector<BDD_ID> order;
+        testObj.visitVars(f, [&](BDD_ID x){ order.push_back(x); });
+        ASSERT_EQ(order.size(), 4);
+    }
+
 
     TEST_F(VariablesTest, And2Constants){
         BDD_ID id_n, id_a = 2;
@@ -343,6 +956,334 @@ namespace ClassProject {
         ASSERT_EQ(testObj.node(id_n), (Node{.low=1, .high=0, .topVar=id_a}));
     }
 
+    TEST_F(VariablesTest, NegComplementEdge){
+        BDD_ID id_a = 2, id_b = 3;
+        BDD_ID id_and = testObj.and2(id_a, id_b);
+        size_t size = testObj.uniqueTableSize();
+
+        BDD_ID id_n = testObj.neg(id_and);
+        ASSERT_EQ(testObj.uniqueTableSize(), size); // negation does not create nodes
+        ASSERT_NE(id_n, id_and);
+        ASSERT_EQ(testObj.neg(id_n), id_and);
+
+        ASSERT_EQ(testObj.topVar(id_n), id_a);
+        ASSERT_EQ(testObj.high(id_n), testObj.neg(id_b));
+        ASSERT_EQ(testObj.low(id_n), 1);
+        ASSERT_EQ(testObj.isVariable(testObj.neg(id_a)), false);
+        ASSERT_EQ(testObj.isExpression(testObj.neg(id_a)), true);
+    }
+
+    TEST_F(VariablesTest, ComplementCanonicalForm){
+        BDD_ID id_a = 2, id_b = 3, id_c = 4;
+
+        ASSERT_EQ(testObj.and2(testObj.neg(id_a), testObj.neg(id_b)), testObj.neg(testObj.or2(id_a, id_b)));
+        ASSERT_EQ(testObj.nand2(id_a, id_b), testObj.neg(testObj.and2(id_a, id_b)));
+        ASSERT_EQ(testObj.xnor2(id_a, id_b), testObj.neg(testObj.xor2(id_a, id_b)));
+        ASSERT_EQ(testObj.ite(testObj.neg(id_a), id_b, id_c), testObj.ite(id_a, id_c, id_b));
+        ASSERT_EQ(testObj.ite(id_a, testObj.neg(id_b), id_c), testObj.neg(testObj.ite(id_a, id_b, testObj.neg(id_c))));
+
+        // a XOR b and its complement share the same node
+        size_t size = testObj.uniqueTableSize();
+        testObj.xnor2(id_b, id_a);
+        ASSERT_EQ(testObj.uniqueTableSize(), size);
+    }
+
+    TEST_F(VariablesTest, IsValid){
+        BDD_ID id_a = 2;
+        ASSERT_EQ(testObj.isValid(0), true);
+        ASSERT_EQ(testObj.isValid(1), true);
+        ASSERT_EQ(testObj.isValid(id_a), true);
+        ASSERT_EQ(testObj.isValid(testObj.neg(id_a)), true);
+        ASSERT_EQ(testObj.isValid(100), false);
+    }
+
+    TEST_F(BasicTest, ConstructorWithComplementedHigh){
+        ASSERT_THROW(Manager(std::vector<Node>{
+            {.low = 0, .high = 0, .topVar = 0},
+            {.low = 1, .high = 1, .topVar = 1},
+            {.low = 1, .high = 0, .topVar = 2}
+        }), std::invalid_argument);
+    }
+
+    TEST_F(BasicTest, StoredNodeLayout){
+    #ifdef COMPACT_NODES
+        ASSERT_EQ(sizeof(StoredNode), 16);
+    #else
+        ASSERT_EQ(sizeof(StoredNode), 20);
+    #endif
+
+        // the level of the top variable is kept inline and decides the order
+        BDD_ID a = testObj.createVar("a");
+        BDD_ID b = testObj.createVar("b");
+        BDD_ID f = testObj.and2(b, a);
+        ASSERT_EQ(testObj.topVar(f), a);
+        ASSERT_EQ(testObj.coFactorTrue(f, b), a);
+        ASSERT_EQ(testObj.coFactorTrue(b, a), b);
+    }
+
+    TEST_F(BasicTest, VariableOrder){
+        BDD_ID a = testObj.createVar("a");
+        BDD_ID b = testObj.createVar("b");
+        BDD_ID c = testObj.createVar("c");
+
+        ASSERT_EQ(testObj.getVariableOrder(), (std::vector<BDD_ID>{a, b, c}));
+        ASSERT_EQ(testObj.getLevel(c), 2);
+        ASSERT_EQ(testObj.varAtLevel(0), a);
+        ASSERT_THROW(testObj.getLevel(testObj.True()), std::invalid_argument);
+
+        testObj.setVariableOrder({c, a, b});
+        ASSERT_EQ(testObj.getLevel(c), 0);
+        ASSERT_EQ(testObj.getLevel(b), 2);
+        ASSERT_EQ(testObj.varAtLevel(1), a);
+
+        // the ids are unchanged, but c is now the top variable
+        BDD_ID f = testObj.and2(a, c);
+        ASSERT_EQ(testObj.topVar(f), c);
+        ASSERT_EQ(testObj.node(f), (Node{.low=0, .high=a, .topVar=c}));
+        ASSERT_EQ(testObj.coFactorTrue(f, a), c);
+        ASSERT_EQ(testObj.coFactorFalse(testObj.or2(b, c), b), c);
+
+        // a new variable is placed below the existing ones
+        BDD_ID d = testObj.createVar("d");
+        ASSERT_EQ(testObj.getLevel(d), 3);
+    }
+
+    TEST_F(BasicTest, SetVariableOrderExceptions){
+        BDD_ID a = testObj.createVar("a");
+        BDD_ID b = testObj.createVar("b");
+
+        ASSERT_THROW(testObj.setVariableOrder({a}), std::invalid_argument);
+        ASSERT_THROW(testObj.setVariableOrder({a, a}), std::invalid_argument);
+        ASSERT_THROW(testObj.setVariableOrder({a, testObj.True()}), std::invalid_argument);
+        ASSERT_THROW(testObj.setVariableOrder({a, b, b}), std::invalid_argument);
+        ASSERT_NO_THROW(testObj.setVariableOrder({b, a}));
+    }
+
+    TEST_F(BasicTest, SetVariableOrderWithExpressions){
+        BDD_ID a = testObj.createVar("a");
+        BDD_ID b = testObj.createVar("b");
+        BDD_ID c = testObj.createVar("c");
+
+        BDDHandle f(testObj, testObj.or2(testObj.and2(a, b), c));
+        BDDHandle g(testObj, testObj.xor2(a, c));
+
+        // the ids stay valid, the nodes are rebuilt in the new order
+        testObj.setVariableOrder({c, b, a});
+        ASSERT_EQ(testObj.getVariableOrder(), (std::vector<BDD_ID>{c, b, a}));
+        ASSERT_EQ(testObj.topVar(f), c);
+        ASSERT_EQ(testObj.high(f), testObj.True());
+        ASSERT_EQ(testObj.low(f), testObj.and2(a, b));
+        ASSERT_EQ(testObj.topVar(g), c);
+        ASSERT_EQ(testObj.high(g), testObj.neg(a));
+        ASSERT_EQ(testObj.low(g), a);
+
+        // new results are built in the new order and agree with the old ones
+        ASSERT_EQ(testObj.or2(c, testObj.and2(b, a)), f.get());
+        ASSERT_EQ(testObj.xnor2(c, a), testObj.neg(g));
+    }
+
+    TEST_F(BasicTest, Sifting){
+        // (x0 & y0) | (x1 & y1) | ... is linear when every x is next to its y
+        // and exponential when all x come before all y
+        const int n = 6;
+        std::vector<BDD_ID> xs, ys;
+        for(int i = 0; i < n; i++)
+            xs.push_back(testObj.createVar("x" + std::to_string(i)));
+        for(int i = 0; i < n; i++)
+            ys.push_back(testObj.createVar("y" + std::to_string(i)));
+
+        BDD_ID f = testObj.False();
+        for(int i = 0; i < n; i++)
+            f = testObj.or2(f, testObj.and2(xs[i], ys[i]));
+        BDDHandle root(testObj, f);
+
+        std::set<BDD_ID> before;
+        testObj.findNodes(root, before);
+
+        // only with the garbage collection enabled the unrooted intermediate results are dropped
+        testObj.setGarbageCollectionThreshold(1 << 20);
+        testObj.reorder();
+
+        std::set<BDD_ID> after;
+        testObj.findNodes(root, after);
+        ASSERT_LT(after.size(), before.size());
+        ASSERT_EQ(after.size(), 2 * n + 2);
+
+        // the same function is still found under the same id
+        BDD_ID g = testObj.False();
+        for(int i = n - 1; i >= 0; i--)
+            g = testObj.or2(testObj.and2(ys[i], xs[i]), g);
+        ASSERT_EQ(g, root.get());
+    }
+
+    TEST_F(BasicTest, ReorderWithoutGarbageCollection){
+        BDD_ID a = testObj.createVar("a");
+        BDD_ID b = testObj.createVar("b");
+        BDD_ID c = testObj.createVar("c");
+
+        // nothing is rooted, with the collection disabled every id stays valid anyway
+        BDD_ID ab = testObj.and2(a, b);
+        BDD_ID f = testObj.or2(ab, c);
+        BDD_ID g = testObj.xor2(a, c);
+        size_t nodes = testObj.uniqueTableSize();
+
+        testObj.setVariableOrder({c, b, a});
+        for(BDD_ID id : {ab, f, g})
+            ASSERT_TRUE(testObj.isValid(id));
+        ASSERT_GE(testObj.uniqueTableSize(), nodes);
+        ASSERT_EQ(testObj.topVar(f), c);
+        ASSERT_EQ(testObj.or2(c, testObj.and2(b, a)), f);
+        ASSERT_EQ(testObj.and2(b, a), ab);
+
+        testObj.reorder();
+        for(BDD_ID id : {ab, f, g})
+            ASSERT_TRUE(testObj.isValid(id));
+        ASSERT_EQ(testObj.xor2(c, a), g);
+        ASSERT_EQ(testObj.or2(testObj.and2(a, b), c), f);
+        ASSERT_EQ(testObj.coFactorTrue(g, a), testObj.neg(c));
+    }
+
+    TEST_F(BasicTest, AutomaticReordering){
+        const int n = 8;
+        std::vector<BDD_ID> xs, ys;
+        for(int i = 0; i < n; i++)
+            xs.push_back(testObj.createVar("x" + std::to_string(i)));
+        for(int i = 0; i < n; i++)
+            ys.push_back(testObj.createVar("y" + std::to_string(i)));
+
+        testObj.setGarbageCollectionThreshold(1 << 20);
+        testObj.setReorderThreshold(64);
+        testObj.setReorderLimits(1.5, 1.0);
+
+        BDDHandle f(testObj, testObj.False());
+        for(int i = 0; i < n; i++)
+            f = BDDHandle(testObj, testObj.or2(f, testObj.and2(xs[i], ys[i])));
+
+        // creation order would need 2^(n+1) nodes
+        std::set<BDD_ID> nodes_of_f;
+        testObj.findNodes(f, nodes_of_f);
+        ASSERT_LT(nodes_of_f.size(), 1 << (n - 1));
+        ASSERT_NE(testObj.getVariableOrder()[1], xs[1]);
+    }
+
+    TEST_F(BasicTest, IteDeepBDD){
+        // the conjunction of the even and the odd variables is a chain over all levels
+        const int n = 50000;
+        std::vector<BDD_ID> vars;
+        for(int i = 0; i < n; i++)
+            vars.push_back(testObj.createVar("x" + std::to_string(i)));
+
+        BDD_ID even = testObj.True(), odd = testObj.True();
+        for(int i = n - 1; i >= 0; i--){
+            if(i % 2 == 0)
+                even = testObj.and2(vars[i], even);
+            else
+                odd = testObj.and2(vars[i], odd);
+        }
+
+        BDD_ID f = testObj.and2(even, odd);
+        for(int i = 0; i < n; i++){
+            ASSERT_EQ(testObj.topVar(f), vars[i]);
+            ASSERT_EQ(testObj.low(f), testObj.False());
+            f = testObj.high(f);
+        }
+        ASSERT_EQ(f, testObj.True());
+
+        // the negated chain goes through the complemented triples
+        BDD_ID g = testObj.or2(testObj.neg(even), testObj.neg(odd));
+        ASSERT_EQ(g, testObj.neg(testObj.and2(odd, even)));
+    }
+
+    TEST_F(BasicTest, GarbageCollectionFreesUnrootedNodes){
+        BDD_ID a = testObj.createVar("a");
+        BDD_ID b = testObj.createVar("b");
+        BDD_ID c = testObj.createVar("c");
+
+        BDD_ID temp = testObj.and2(testObj.or2(a, b), c);
+        BDDHandle kept(testObj, testObj.xor2(a, c));
+        size_t size = testObj.uniqueTableSize();
+
+        ASSERT_GT(testObj.collectGarbage(), 0);
+        ASSERT_LT(testObj.uniqueTableSize(), size);
+        ASSERT_FALSE(testObj.isValid(temp));
+        ASSERT_TRUE(testObj.isValid(kept));
+        ASSERT_TRUE(testObj.isVariable(a));
+        ASSERT_EQ(testObj.high(kept), testObj.neg(c));
+
+        // a second collection has nothing left to free
+        ASSERT_EQ(testObj.collectGarbage(), 0);
+    }
+
+    TEST_F(BasicTest, GarbageCollectionReusesSlots){
+        BDD_ID a = testObj.createVar("a");
+        BDD_ID b = testObj.createVar("b");
+        BDD_ID c = testObj.createVar("c");
+
+        BDD_ID temp = testObj.and2(b, c);
+        testObj.collectGarbage();
+
+        BDD_ID f = testObj.and2(a, c);
+        ASSERT_EQ(f, temp);
+        ASSERT_EQ(testObj.node(f), (Node{.low=0, .high=c, .topVar=a}));
+
+        // the stale computed table entry of and2(b, c) must not be returned
+        BDD_ID g = testObj.and2(b, c);
+        ASSERT_NE(g, f);
+        ASSERT_EQ(testObj.node(g), (Node{.low=0, .high=c, .topVar=b}));
+
+        // a variable is never placed into a freed slot
+        testObj.collectGarbage();
+        ASSERT_GT(testObj.createVar("d"), c);
+    }
+
+    TEST_F(BasicTest, BDDHandleCopyAndMove){
+        BDD_ID a = testObj.createVar("a");
+        BDD_ID b = testObj.createVar("b");
+        BDD_ID f = testObj.or2(a, b);
+
+        BDDHandle first(testObj, f);
+        {
+            BDDHandle copy = first;
+            BDDHandle moved = std::move(first);
+        }
+        testObj.collectGarbage();
+        ASSERT_FALSE(testObj.isValid(f));
+
+        f = testObj.or2(a, b);
+        BDDHandle handle(testObj, f);
+        BDDHandle other;
+        other = handle;
+        handle = BDDHandle(testObj, a);
+        testObj.collectGarbage();
+        ASSERT_TRUE(testObj.isValid(f));
+        ASSERT_EQ(other.get(), f);
+    }
+
+    TEST_F(BasicTest, AutomaticGarbageCollection){
+        std::vector<BDD_ID> vars;
+        for(int i = 0; i < 16; i++)
+            vars.push_back(testObj.createVar("x" + std::to_string(i)));
+
+        testObj.setGarbageCollectionThreshold(200);
+
+        // only the accumulator is rooted, every partial product becomes garbage
+        size_t peak = 0;
+        BDDHandle f(testObj, testObj.False());
+        for(int round = 0; round < 8; round++){
+            for(size_t i = 0; i < vars.size(); i++){
+                BDD_ID product = testObj.and2(vars[i], vars[(i + round + 1) % vars.size()]);
+                f = BDDHandle(testObj, testObj.xor2(f, product));
+                peak = std::max(peak, testObj.uniqueTableSize());
+            }
+        }
+
+        std::set<BDD_ID> nodes_of_f;
+        testObj.findNodes(f, nodes_of_f);
+        ASSERT_LT(peak, 2 * std::max<size_t>(200, 2 * nodes_of_f.size()));
+        for(BDD_ID node : nodes_of_f)
+            ASSERT_TRUE(testObj.isValid(node));
+    }
+
     TEST_F(VariablesTest, Xor2Constants){
         BDD_ID id_n, id_m, id_a = 2;
         id_n = testObj.xor2(0, 0);